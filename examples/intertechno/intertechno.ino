@@ -19,15 +19,18 @@
  * * a transmitter can be attached with data to pin D6.
  *
  * Use the Serial Monitor to see the received codes and send the predefined codes.
+ * The received codes and timings are passed through a SignalOutput so printing never blocks receiving.
 */
 
 #include <Arduino.h>
 #include <RFCodes.h>
+#include <SignalOutput.h>
 
 bool showRaw = false;
 
 SignalParser sig;
 SignalCollector col;
+SignalOutput out;
 
 // ===== Cresta protocol decoding =====
 
@@ -93,28 +96,15 @@ void cresta_decode(const char *p)
 // This function will be called when a complete protcol was received.
 void receiveCode(const char *proto)
 {
-  SignalParser::CodeTime lastProbes[120 + 1]; // dividable by 8 is preferred.
-  Serial.printf("received [%s]\n", proto);
+  out.writeFrame(proto);
 
   // analysing supporting callback
   if (showRaw) {
-    col.getBufferData(lastProbes, 120 + 1);
-
-    // dump probes
-    SignalParser::CodeTime *p = lastProbes;
-    int len = 0;
-    while (len < 121 && *p) {
-      if (len % 8 == 0) {
-        Serial.printf("%3d: %5u,", len, *p);
-      } else if (len % 8 == 7) {
-        Serial.printf(" %5u,\n", *p);
-      } else {
-        Serial.printf(" %5u,", *p);
-      }
-      p++;
-      len++;
-    } // while
-    Serial.println();
+    // dump the timings of this sequence
+    SignalCollector::TimingSpan span;
+    if (col.getFrameTimings(&span)) {
+      out.writeTimings(&span);
+    } // if
   } // if
 
   if (strncmp(proto, "cw ", 3) == 0) {
@@ -130,6 +120,9 @@ void setup()
   Serial.println("RFCodes Intertechno Example");
   Serial.println();
 
+  // buffered output of the received codes
+  out.begin(&Serial);
+
   Serial.println(
       "Commands: 1-2(Send Code) D(ump Code Table) R(aw toggle)");
 
@@ -144,6 +137,7 @@ void setup()
 
   // initialize the SignalCollector library
   col.init(&sig, D5, D6); // input at pin D5, output at pin D6
+  col.keepTimings(showRaw); // the timings are only kept for the raw mode
 
   if (showRaw)
     Serial.println("Raw mode is enabled");
@@ -184,6 +178,7 @@ void loop()
 
     } else if (cmd == 'R') {
       showRaw = !showRaw;
+      col.keepTimings(showRaw);
       if (showRaw)
         Serial.println("Raw mode is enabled");
       else
@@ -205,4 +200,7 @@ void loop()
 
   // process received bytes
   col.loop();
+
+  // print received codes as far as Serial can take them
+  out.loop();
 } // loop()
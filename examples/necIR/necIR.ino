@@ -28,30 +28,15 @@ SignalCollector tabRF;
 // This function will be called when a complete protcol was received.
 void receiveCode(const char *proto)
 {
-  SignalParser::CodeTime lastProbes[152]; // dividable by 8 is preferred.
-  // remember last code in a local variable
   Serial.printf("[%s]\n", proto);
 
   // analysing supporting callback
-  if (showRaw && (*proto == '*')) {
-    int n = atoi(proto + 1) + 1;
-    tabRF.getBufferData(lastProbes, min(n, 150));
-
-    // dump probes
-    SignalParser::CodeTime *p = lastProbes;
-    int len = 0;
-    while (len < 150 && *p) {
-      if (len % 8 == 0) {
-        Serial.printf("%3d: %5u,", len, *p);
-      } else if (len % 8 == 7) {
-        Serial.printf(" %5u,\n", *p);
-      } else {
-        Serial.printf(" %5u,", *p);
-      }
-      p++;
-      len++;
-    } // while
-    Serial.println();
+  if (showRaw) {
+    // dump the timings of this sequence
+    SignalCollector::TimingSpan span;
+    if (tabRF.getFrameTimings(&span)) {
+      tabRF.dumpTimings(&span);
+    } // if
   } // if
 } // receiveCode()
 
@@ -64,9 +49,16 @@ void setup()
 
   // initialize the tabRF library
   tabRF.init(&sig, D7, NO_PIN, 16); // input at pin D7, no output
+  tabRF.keepTimings(showRaw); // the timings are only kept for the raw mode
+
+  // finish shorter sequences after 20 msec without signal changes.
+  tabRF.setIdleTimeout(20000);
 
 
   sig.load(&IRCodes::nec);
+
+  // start with a trim of 16 µsecs and follow the receiver.
+  sig.learnTrim();
   sig.dumpTable();
 
   if (showRaw)
@@ -102,6 +94,7 @@ void loop()
 
     } else if (cmd == 'R') {
       showRaw = !showRaw;
+      tabRF.keepTimings(showRaw);
 
     } // if
   } // if
@@ -1,25 +1,32 @@
 /**
  * @file: scanner.ino
- * 
+ *
  * This file is part of the RFCodes library that implements receiving an sending
  * RF and IR protocols.
- * 
+ *
  * @copyright Copyright (c) by Matthias Hertel, https://www.mathertel.de.
  *
  * This work is licensed under a BSD 3-Clause style license,
  * https://www.mathertel.de/License.aspx.
- * 
+ *
  * @brief
  *
  * This sample is part of the RFCodes library.
  * It can be used to collect some probes from a specific sender where you don't know the exact timings.
+ * It uses the capture mode of the SignalCollector with triggers for a long timing
+ * and the start codes of the loaded protocols while the protocols are still decoded.
+ * Repeated signals of unknown senders are reported by their fingerprint.
  *
  * More info at: http://www.mathertel.de/Arduino/
- * 
+ *
  * * 31.03.2022 created by Matthias Hertel
+ * * 18.10.2026 using the capture mode of the SignalCollector.
+ * * 18.10.2026 fingerprints of unknown signals.
 */
 
 #include <Arduino.h>
+#include <RFCodes.h>
+#include <SignalFingerprint.h>
 
 #define BACKSIZE 512
 #define RECORDSIZE 512
@@ -29,112 +36,51 @@ static int startPin = D5;
 static int receiverPin = D7;
 static int ledPin = D4;
 
-static int interruptPin = 0;
-
-volatile int status;
-int lastStatus;
+SignalParser sig;
+SignalCollector col;
+SignalFingerprint fp;
 
-#define STATUS_PAUSE 0x00 // do nothing
-#define STATUS_WAIT 0x01 // just fill the buffer for 512
-#define STATUS_CHECK 0x02 // check for starting condition
-#define STATUS_START 0x04 // record
-#define STATUS_ISRECORD (STATUS_WAIT | STATUS_CHECK | STATUS_START)
-#define STATUS_DONE 0x80 // done
+SignalParser::CodeTime samples[SAMPLESIZE];
 
-bool done = false;
+int lastState;
 
-typedef uint16_t CodeTime;
+// export of the captured timings
+SignalCollector::TimingSpan span;
+int exportPos = -1; // position of the next timing to be exported or -1.
 
-// last time the interrupt was called.
-volatile static unsigned long lastTime;
 
-
-// Ring buffer
-// A simple ring buffer is used to decouple interrupt routine.
-// Static variables are used to be known in the ISR
-static CodeTime *buf88; // allocated memory
-static volatile CodeTime *buf88_write; // write pointer
-static volatile CodeTime *buf88_read; // read pointer
-static CodeTime *buf88_end; // end of buffer+1 pointer for wrapping
-static volatile unsigned int buf88_cnt; // number of bytes in buffer
-
-
-// This handler is attached to the change interrupt.
-void IRAM_ATTR handleInterrupt()
+// This function will be called when a complete protcol was received
+// or a fingerprint "fp <hash> <length> <base>" of an unknown signal was found.
+void receiveCode(const char *code)
 {
-  unsigned long now = micros();
-  CodeTime t = (CodeTime)(now - lastTime);
-  lastTime = now;
-
-  if (status & STATUS_ISRECORD) {
-    digitalWrite(ledPin, !digitalRead(receiverPin));
-
-    // record using the write pointer, read pointer is not valid.
-    // count may exceed the buffer size
-    *buf88_write++ = t;
-
-    // reset pointer to the start when reaching end
-    if (buf88_write == buf88_end)
-      buf88_write = buf88;
-    buf88_cnt++;
-
-    if (status == STATUS_WAIT) {
-      if (buf88_cnt >= BACKSIZE) {
-        // start checking condition
-        status = STATUS_CHECK;
-      }
+  Serial.printf("received [%s]\n", code);
+} // receiveCode()
 
-    } else if (status == STATUS_CHECK) {
-      // the last timings will be in the ring buffer when looking backwards.
 
-      // ===== CHANGE STARTING CONDITION HERE:
-
-      if ((t > 8000) && (t < 10000)) {
-      // if ((t > 80) && (t < 1400)) {
-        // a long time is detected, possibly a sync code
-        status = STATUS_START;
-        buf88_read = buf88_write;
-        buf88_cnt = 0;
-      } // if
-
-    } else if (status == STATUS_START) {
-      // continue recording and count.
-
-      if (buf88_cnt == RECORDSIZE) {
-        status = STATUS_DONE;
-        digitalWrite(ledPin, HIGH); // off
-      }
-
-    } // if
-  } // if
-} // handleInterrupt
-
-/** dump the data from a table of timings that end with a 0 time. */
-void dumpBuffer(CodeTime *raw, int size)
+/** export some captured timings when the Serial output has space for them. */
+void exportTimings()
 {
+  int trigger = col.getCapture(&span);
+  int len = span.firstLength + span.secondLength;
 
-  // dump timing probes
-  CodeTime *p = raw;
-  int len = 0;
-
-  if (p < buf88)
-    p += SAMPLESIZE;
+  if (Serial.availableForWrite() < 8 * 7) {
+    return; // try again later without blocking.
+  }
 
-  while (len < size) {
-    Serial.print(*p);
-    if (len % 32 != 31) {
-      Serial.print(',');
-    } else {
-      Serial.println(',');
-    }
-    p++;
-    len++;
+  for (int n = 0; (n < 8) && (exportPos < len); n++) {
+    SignalParser::CodeTime t = (exportPos < span.firstLength) ? span.first[exportPos] : span.second[exportPos - span.firstLength];
+    Serial.printf("%u%c", t, (exportPos == trigger) ? ';' : ',');
+    exportPos++;
+    if (exportPos % 32 == 0)
+      Serial.println();
+  } // for
 
-    // reset pointer to the start when reaching end
-    if (p == buf88_end)
-      p = buf88;
-  } // while
-} // dumpBuffer()
+  if (exportPos == len) {
+    Serial.println();
+    Serial.println("---");
+    exportPos = -1;
+  }
+} // exportTimings()
 
 
 void setup()
@@ -144,22 +90,21 @@ void setup()
 
   Serial.println("RF Scanner...");
 
-  status = STATUS_PAUSE;
+  col.init(&sig, receiverPin, NO_PIN);
 
-  // setup ring buffer
-  buf88 = (CodeTime *)malloc(SAMPLESIZE * sizeof(CodeTime)); // allocated memory
-  buf88_end = buf88 + SAMPLESIZE; // end of buffer+1 pointer for wrapping
-  buf88_write = buf88;
-  buf88_read = buf88;
-  buf88_cnt = 0;
+  sig.load(&RFCodes::it1);
+  sig.load(&RFCodes::it2);
+  sig.load(&RFCodes::sc5);
+  sig.attachCallback(receiveCode);
+  sig.attachFingerprint(&fp);
 
-  // setup interrupt routine
-  interruptPin = digitalPinToInterrupt(receiverPin);
-  attachInterrupt(interruptPin, handleInterrupt, CHANGE);
+  // ===== CHANGE STARTING CONDITION HERE:
+  // a long time is detected, possibly a sync code
+  col.addTrigger(8000, 10000);
+  // col.addTrigger("it2");
 
   pinMode(ledPin, OUTPUT);
   pinMode(startPin, INPUT_PULLUP);
-  pinMode(receiverPin, INPUT_PULLUP);
 
   // show activity.
   for (int i = 0; i < 4; i++) {
@@ -173,58 +118,41 @@ void setup()
 
 void loop()
 {
-  if (status == STATUS_PAUSE) {
-    lastStatus = status;
+  int state = col.getCaptureState();
+
+  if (exportPos >= 0) {
+    exportTimings();
+
+  } else if ((state == SC_CAPTURE_OFF) || (state == SC_CAPTURE_DONE)) {
     if (digitalRead(startPin) == LOW) {
       Serial.print("press...");
-      while (digitalRead(startPin) == HIGH) {
+      while (digitalRead(startPin) == LOW) {
         delay(20);
       }
       Serial.println("done.");
       delay(200);
-      lastTime = micros();
-      status = STATUS_WAIT; // Now interrupt will start recording any timings
+      col.startCapture(samples, SAMPLESIZE, BACKSIZE);
     }
 
-  } else if (status == STATUS_WAIT) {
-    if (lastStatus != status) {
-      Serial.println("wait...");
-      lastStatus = status;
-    }
-
-  } else if (status == STATUS_CHECK) {
-    if (lastStatus != status) {
+  } else if (state != lastState) {
+    if (state == SC_CAPTURE_ARMED) {
       Serial.println("check...");
-      lastStatus = status;
-    }
-    if (digitalRead(startPin) == LOW) {
-      status = STATUS_START;
-      buf88_read = buf88_write;
-      buf88_cnt = 0;
+      digitalWrite(ledPin, LOW); // on
+    } else if (state == SC_CAPTURE_RECORD) {
+      Serial.println("collect...");
     }
+  }
 
-  } else if (status == STATUS_START) {
-    if (lastStatus != status) {
-      Serial.print("collect...");
-      lastStatus = status;
-    }
-    Serial.print('.'); // show some progress
-    delay(30);
-
-  } else if (status == STATUS_DONE) {
-    // report timings
-    Serial.println("done.");
-
-    // print buffer before read
-
-    dumpBuffer((CodeTime *)buf88_read - BACKSIZE, BACKSIZE);
-    Serial.println("---");
-    dumpBuffer((CodeTime *)buf88_read, RECORDSIZE);
-    Serial.println();
-
-    // done.
-    status = STATUS_PAUSE;
+  if ((state == SC_CAPTURE_DONE) && (lastState != SC_CAPTURE_DONE)) {
+    // report timings, the trigger timing is followed by a ';'
+    Serial.printf("done by trigger %d.\n", col.getCaptureTrigger());
+    digitalWrite(ledPin, HIGH); // off
+    col.getCapture(&span);
+    exportPos = 0;
   }
+  lastState = state;
+
+  col.loop();
 } // loop()
 
 // End.
@@ -0,0 +1,229 @@
+/**
+ * @file: simulator.ino
+ *
+ * This file is part of the RFCodes library that implements receiving an sending
+ * RF and IR protocols.
+ *
+ * @copyright Copyright (c) by Matthias Hertel, https://www.mathertel.de.
+ *
+ * This work is licensed under a BSD 3-Clause style license,
+ * https://www.mathertel.de/License.aspx.
+ *
+ * @brief
+ *
+ * This sample is part of the RFCodes library.
+ * It uses the SignalSimulator to create random code sequences for all protocols
+ * and passes them through a simulated channel with jitter, clock skew, glitches,
+ * dropouts, noise and overlapping senders into the SignalParser.
+ *
+ * The result is a matrix with the decode rate per protocol and channel, the number
+ * of wrong decodes and the parsing time per timing.
+ * The random numbers start with a fixed seed so the results are repeatable and can be
+ * used to compare tolerance settings and changes of the parser.
+ *
+ * The benchmark replays a long simulated capture and compares parsing single timings
+ * with parsing blocks of timings using the scalar and the best SignalClassifier kernel.
+ *
+ * Use the Serial Monitor and send 'S' to start the simulation or 'B' to start the benchmark.
+ *
+ * More info at: http://www.mathertel.de/Arduino/
+ *
+ * * 18.10.2026 created by agent
+ * * 18.10.2026 benchmark of parsing blocks of timings.
+ */
+
+#include <Arduino.h>
+#include <SignalParser.h>
+#include <SignalSimulator.h>
+#include <SignalClassifier.h>
+
+#include <ircodes.h>
+#include <protocols.h>
+
+#define FRAMES 100  // number of simulated sequences per protocol and channel
+
+#define BENCH_TIMINGS 8192  // number of timings in the benchmark capture
+#define BENCH_ROUNDS 20     // number of replays of the capture
+
+SignalParser sig;
+SignalSimulator sim;
+
+SignalParser::Protocol *protocols[] = {
+  &RFCodes::it1, &RFCodes::it2, &RFCodes::sc5, &RFCodes::ev1527, &RFCodes::cw, &IRCodes::nec
+};
+#define PROTOCOLS (sizeof(protocols) / sizeof(protocols[0]))
+
+struct Condition {
+  const char *name;
+  SignalSimulator::Channel channel;
+};
+
+// jitter%, skew%, glitch‰, dropout‰, noise, overlap%
+Condition conditions[] = {
+  { "clean", { 0, 0, 0, 0, 0, 0 } },
+  { "jitter 10%", { 10, 0, 0, 0, 8, 0 } },
+  { "jitter 20%", { 20, 0, 0, 0, 8, 0 } },
+  { "skew 10%", { 5, 10, 0, 0, 8, 0 } },
+  { "skew 20%", { 5, 20, 0, 0, 8, 0 } },
+  { "glitch 5", { 5, 0, 5, 0, 8, 0 } },
+  { "dropout 5", { 5, 0, 0, 5, 8, 0 } },
+  { "noise 40", { 5, 0, 0, 0, 40, 0 } },
+  { "overlap 20%", { 5, 0, 0, 0, 8, 20 } },
+  { "mixed", { 10, 10, 2, 2, 20, 10 } }
+};
+#define CONDITIONS (sizeof(conditions) / sizeof(conditions[0]))
+
+SignalParser::CodeTime timings[SIM_BUFFERSIZE + 64];
+SignalParser::CodeTime capture[BENCH_TIMINGS];
+
+// current sequence and results
+const char *expected;
+bool found;
+unsigned long wrongCount;  // decoded sequences with the expected protocol but other codes.
+unsigned long otherCount;  // decoded sequences of other protocols.
+unsigned long codeCount;   // decoded sequences in the benchmark.
+
+
+// This function will be called when a complete protcol was received.
+void receiveCode(const char *code) {
+  if (!expected) {
+    codeCount++;
+    return;
+  }
+
+  int len = strchr(expected, ' ') - expected + 1;
+
+  if (strcmp(code, expected) == 0) {
+    found = true;
+  } else if (strncmp(code, expected, len) == 0) {
+    wrongCount++;
+  } else {
+    otherCount++;
+  }
+}  // receiveCode()
+
+
+// run all sequences through all channels and print the matrix.
+void simulate() {
+  sim.init(&sig, protocols, PROTOCOLS, 4711);
+
+  Serial.printf("%-12s", "channel");
+  for (unsigned int n = 0; n < PROTOCOLS; n++) {
+    Serial.printf("|%7s", protocols[n]->name);
+  }
+  Serial.printf("| wrong | other | ns/timing\n");
+
+  for (unsigned int cn = 0; cn < CONDITIONS; cn++) {
+    Condition *cond = &conditions[cn];
+    unsigned long timingCount = 0;
+    unsigned long duration = 0;
+    wrongCount = 0;
+    otherCount = 0;
+
+    Serial.printf("%-12s", cond->name);
+
+    for (unsigned int n = 0; n < PROTOCOLS; n++) {
+      int decoded = 0;
+
+      for (int f = 0; f < FRAMES; f++) {
+        expected = sim.randomCode(n);
+        found = false;
+
+        int cnt = sim.transmit(expected, cond->channel, timings, SIM_BUFFERSIZE + 64);
+
+        unsigned long start = micros();
+        for (int i = 0; i < cnt; i++) {
+          sig.parse(timings[i]);
+        }
+        duration += micros() - start;
+        timingCount += cnt;
+
+        if (found) decoded++;
+        yield();
+      }  // for
+
+      Serial.printf("|%6d%%", (decoded * 100) / FRAMES);
+    }  // for
+
+    Serial.printf("|%6lu |%6lu | %lu\n", wrongCount, otherCount,
+                  timingCount ? (duration * 1000) / timingCount : 0);
+  }  // for
+}  // simulate()
+
+
+// replay a capture with all protocols using single timings and blocks of timings.
+void benchmark() {
+  sim.init(&sig, protocols, PROTOCOLS, 4711);
+
+  // create the capture using the mixed channel.
+  int cnt = 0;
+  while (cnt < BENCH_TIMINGS - SIM_BUFFERSIZE) {
+    const char *code = sim.randomCode(sim.random(PROTOCOLS));
+    cnt += sim.transmit(code, conditions[CONDITIONS - 1].channel, capture + cnt, BENCH_TIMINGS - cnt);
+  }
+  expected = nullptr;
+
+  Serial.printf("%-12s| codes | ns/timing\n", "parser");
+
+  for (int mode = 0; mode < 3; mode++) {
+    char name[16];
+
+    if (mode == 0) {
+      strcpy(name, "single");
+    } else {
+      SignalClassifier::useKernel(mode == 1 ? "scalar" : nullptr);
+      sprintf(name, "block %s", SignalClassifier::getKernel());
+    }
+
+    codeCount = 0;
+    unsigned long start = micros();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+      if (mode == 0) {
+        for (int i = 0; i < cnt; i++) {
+          sig.parse(capture[i]);
+        }
+      } else {
+        sig.parse(capture, cnt);
+      }
+      yield();
+    }  // for
+    unsigned long duration = micros() - start;
+
+    Serial.printf("%-12s|%6lu | %lu\n", name, codeCount, (duration * 1000) / (BENCH_ROUNDS * cnt));
+  }  // for
+}  // benchmark()
+
+
+void setup() {
+  delay(3000);  // wait for serial monitor to be ready.
+  Serial.begin(115200);
+  Serial.println("RFCodes channel simulator...");
+  Serial.println();
+
+  Serial.println("Commands: S(imulate) B(enchmark)");
+
+  // random codes are no valid cresta data bytes.
+  RFCodes::cw.validate = nullptr;
+
+  // load all protocols
+  for (unsigned int n = 0; n < PROTOCOLS; n++) {
+    sig.load(protocols[n]);
+  }
+  sig.dumpTable();
+
+  sig.attachCallback(receiveCode);
+}  // setup()
+
+
+void loop() {
+  if (Serial.available() > 0) {
+    char cmd = Serial.read();
+    if (cmd == 'S') {
+      simulate();
+    } else if (cmd == 'B') {
+      benchmark();
+    }  // if
+  }  // if
+}  // loop()
+
+// End.
@@ -16,6 +16,7 @@
  * by injecting timings and verifying that codes could be detected.
  *
  * Use the Serial Monitor to see the received codes and send the predefined codes.
+ * The test data can also be checked on a host using the corpus runner in extras/corpus.
  *
  * More info at: http://www.mathertel.de/Arduino/
  * 
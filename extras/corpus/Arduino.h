@@ -0,0 +1,110 @@
+/**
+ * @file: Arduino.h
+ *
+ * This file is part of the RFCodes library that implements receiving an sending
+ * RF and IR protocols.
+ *
+ * @copyright Copyright (c) by Matthias Hertel, https://www.mathertel.de.
+ *
+ * This work is licensed under a BSD 3-Clause style license,
+ * https://www.mathertel.de/License.aspx.
+ *
+ * @brief
+ * The Arduino functions used by the library for compiling it on a host without any hardware.
+ * The IO pins do nothing and the time is taken from the steady clock of the host.
+ * delayMicroseconds() does not wait but advances the time returned by micros().
+ *
+ * Changelog:
+ * * 18.10.2026 created by agent
+ */
+
+#ifndef Arduino_H_
+#define Arduino_H_
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define IRAM_ATTR
+
+#define LOW 0
+#define HIGH 1
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define CHANGE 3
+
+// time passed by delayMicroseconds() without waiting.
+inline unsigned long &delayedMicros() {
+  static unsigned long delayed = 0;
+  return (delayed);
+}
+
+inline unsigned long micros() {
+  static auto start = std::chrono::steady_clock::now();
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()
+         + delayedMicros();
+}
+
+inline unsigned long millis() {
+  return (micros() / 1000);
+}
+
+inline void delay(unsigned long) {}
+inline void delayMicroseconds(unsigned int us) {
+  delayedMicros() += us;
+}
+inline void yield() {}
+
+inline void pinMode(int, int) {}
+inline void digitalWrite(int, int) {}
+inline int digitalRead(int) {
+  return (LOW);
+}
+
+inline int digitalPinToInterrupt(int) {
+  return (-1);  // no interrupts on a host.
+}
+inline void attachInterrupt(int, void (*)(), int) {}
+inline void detachInterrupt(int) {}
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+inline long random(long max) {
+  return (max > 0 ? rand() % max : 0);
+}
+
+// A Stream writing to stdout.
+class Stream {
+public:
+  virtual ~Stream() {}
+
+  virtual size_t write(const uint8_t *buffer, size_t size) {
+    return (fwrite(buffer, 1, size, stdout));
+  }
+
+  virtual int availableForWrite() {
+    return (1024);
+  }
+
+  int printf(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = vprintf(format, args);
+    va_end(args);
+    return (n);
+  }
+
+  void println() {
+    putchar('\n');
+  }
+};  // class Stream
+
+extern Stream Serial;
+
+#endif  // Arduino_H_
@@ -0,0 +1,636 @@
+/**
+ * @file: corpus_runner.cpp
+ *
+ * This file is part of the RFCodes library that implements receiving an sending
+ * RF and IR protocols.
+ *
+ * @copyright Copyright (c) by Matthias Hertel, https://www.mathertel.de.
+ *
+ * This work is licensed under a BSD 3-Clause style license,
+ * https://www.mathertel.de/License.aspx.
+ *
+ * @brief
+ * Run a corpus of recorded timings through the SignalCollector and SignalParser on a host,
+ * compare the decoded codes with the expected codes and measure the time per timing.
+ * Every decoded code is sent again and the recorded envelope must be decoded to the same code.
+ * All classifier kernels supported by the cpu must create the same masks as the scalar kernel.
+ * See README.md for the format of the corpus.
+ *
+ * Changelog:
+ * * 18.10.2026 created by agent
+ */
+
+#include <Arduino.h>
+
+#include <SignalClassifier.h>
+#include <SignalCollector.h>
+#include <SignalParser.h>
+#include <SignalReceiver.h>
+
+#include <ircodes.h>
+#include <protocols.h>
+
+#include <algorithm>
+#include <dirent.h>
+#include <new>
+#include <string>
+#include <vector>
+
+Stream Serial;
+
+// ===== heap accounting =====
+
+// All allocations are counted by wrapping malloc() so the heap used by the parser and every
+// allocation while parsing are found independent of the caches of the allocator.
+// operator new is replaced to use malloc() on any C++ runtime.
+
+static long heapBytes = 0;          // bytes allocated and not freed
+static unsigned long heapCalls = 0;  // number of allocations
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#define CR_HEAP
+
+extern "C" {
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+void *malloc(size_t size) {
+  void *p = __libc_malloc(size);
+  if (p) {
+    heapCalls++;
+    heapBytes += malloc_usable_size(p);
+  }
+  return (p);
+}
+
+void *calloc(size_t n, size_t size) {
+  void *p = __libc_calloc(n, size);
+  if (p) {
+    heapCalls++;
+    heapBytes += malloc_usable_size(p);
+  }
+  return (p);
+}
+
+void *realloc(void *ptr, size_t size) {
+  long old = (ptr ? malloc_usable_size(ptr) : 0);
+  void *p = __libc_realloc(ptr, size);
+  if (p) {
+    heapCalls++;
+    heapBytes += (long)malloc_usable_size(p) - old;
+  } else if (!size) {
+    heapBytes -= old;
+  }
+  return (p);
+}
+
+void free(void *ptr) {
+  if (ptr) {
+    heapBytes -= malloc_usable_size(ptr);
+  }
+  __libc_free(ptr);
+}
+}  // extern "C"
+#endif
+
+void *operator new(size_t size) {
+  void *p = malloc(size ? size : 1);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return (p);
+}
+
+void *operator new[](size_t size) {
+  return (operator new(size));
+}
+
+void operator delete(void *p) noexcept {
+  free(p);
+}
+
+void operator delete[](void *p) noexcept {
+  free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+  free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+  free(p);
+}
+
+// all protocols of the library.
+static SignalParser::Protocol *protocols[] = {
+  &RFCodes::it1, &RFCodes::it2, &RFCodes::sc5, &RFCodes::ev1527, &RFCodes::cw, &IRCodes::nec
+};
+#define PROTOCOLS (sizeof(protocols) / sizeof(protocols[0]))
+
+static const char *kernels[] = { "scalar", "sse2", "avx2" };
+#define KERNELS (sizeof(kernels) / sizeof(kernels[0]))
+
+// ===== options =====
+
+static bool optUpdate = false;        // write the expected codes
+static bool optBlock = false;         // pass the timings in blocks using SignalReceiverReplay
+static const char *optBaseline = nullptr;  // file with the times of a previous run
+static const char *optSave = nullptr;      // file to save the times of this run
+static int optThreshold = 20;         // allowed slowdown in percent
+static const char *optKernel = nullptr;    // classifier kernel used for parsing blocks
+
+// ===== state of the current corpus =====
+
+static std::vector<std::string> decoded;
+static bool recording = false;
+static std::vector<std::string> *blockDecoded = nullptr;  // codes decoded by parsing the capture in one block
+
+static char sentDecoded[PROTNAME_LEN + MAX_SEQUENCE_LENGTH + 1];  // first code decoded from a sent envelope
+
+static SignalCollector col;
+
+
+// This function will be called when a complete protcol was received.
+void receiveCode(const char *code) {
+  if (recording) {
+    decoded.push_back(code);
+  }
+}  // receiveCode()
+
+
+// This function will be called when a code was decoded by parsing the capture in one block.
+void receiveBlock(const char *code) {
+  blockDecoded->push_back(code);
+}  // receiveBlock()
+
+
+// This function will be called when a code was decoded from a sent envelope.
+void receiveSent(const char *code) {
+  if (!sentDecoded[0]) {
+    snprintf(sentDecoded, sizeof(sentDecoded), "%s", code);
+  }
+}  // receiveSent()
+
+
+/** return the bytes allocated on the heap or 0 when not available. */
+static long heapUsed() {
+  return (heapBytes);
+}  // heapUsed()
+
+
+/** return the number of allocations or 0 when not available. */
+static unsigned long heapAllocations() {
+  return (heapCalls);
+}  // heapAllocations()
+
+
+/** read a text file into lines. */
+static bool readLines(const std::string &fileName, std::vector<std::string> &lines) {
+  FILE *f = fopen(fileName.c_str(), "r");
+  char line[512];
+
+  if (!f) {
+    return (false);
+  }
+  while (fgets(line, sizeof(line), f)) {
+    line[strcspn(line, "\r\n")] = '\0';
+    if (line[0]) {
+      lines.push_back(line);
+    }
+  }
+  fclose(f);
+  return (true);
+}  // readLines()
+
+
+/** read the timings of a capture and the protocols to be loaded.
+ * The timings are numbers separated by any other characters like the output of the scanner,
+ * comments start with '#' or "//" until the end of the line or are enclosed in "/ *" and "* /".
+ * A comment "# protocols: it1 it2" defines the protocols to be loaded instead of all protocols.
+ * A comment "# trim: learn" enables learning the trim.
+ */
+static bool readCapture(const std::string &fileName, std::vector<SignalParser::CodeTime> &timings, std::string &protNames, bool &trimLearn) {
+  FILE *f = fopen(fileName.c_str(), "r");
+  if (!f) {
+    return (false);
+  }
+
+  std::string text;
+  char buffer[4096];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+    text.append(buffer, n);
+  }
+  fclose(f);
+
+  const char *s = text.c_str();
+  while (*s) {
+    if ((*s == '#') || ((s[0] == '/') && (s[1] == '/'))) {
+      std::string comment(s, strcspn(s, "\r\n"));
+      size_t pos = comment.find("protocols:");
+      if (pos != std::string::npos) {
+        protNames = comment.substr(pos + 10);
+      }
+      if (comment.find("trim: learn") != std::string::npos) {
+        trimLearn = true;
+      }
+      s += comment.length();
+
+    } else if ((s[0] == '/') && (s[1] == '*')) {
+      const char *end = strstr(s + 2, "*/");
+      s = end ? end + 2 : s + strlen(s);
+
+    } else if ((*s >= '0') && (*s <= '9')) {
+      unsigned long t = strtoul(s, (char **)&s, 10);
+      timings.push_back(SignalParser::toCodeTime(t));
+
+    } else {
+      s++;
+    }
+  }  // while
+  return (true);
+}  // readCapture()
+
+
+/** load the protocols of a capture, all protocols when no names are given. */
+static void loadProtocols(SignalParser *sig, const std::string &protNames) {
+  for (unsigned int n = 0; n < PROTOCOLS; n++) {
+    if (protNames.empty() || (std::string(" " + protNames + " ").find(std::string(" ") + protocols[n]->name + " ") != std::string::npos)) {
+      sig->load(protocols[n]);
+    }
+  }
+}  // loadProtocols()
+
+
+/** pass all timings to the collector and parser. */
+static void runTimings(const std::vector<SignalParser::CodeTime> &timings) {
+  if (optBlock) {
+    SignalReceiverReplay replay(timings.data(), timings.size(), SP_BLOCKSIZE);
+    col.attachReceiver(&replay);
+    while (!replay.done()) {
+      col.loop();
+    }
+    col.attachReceiver(nullptr);
+
+  } else {
+    // parse before the ring buffer can be filled.
+    int batch = SC_BUFFERSIZE / 4;
+    for (size_t n = 0; n < timings.size(); n++) {
+      col.injectTiming(timings[n]);
+      if ((n % batch) == (size_t)(batch - 1)) {
+        col.loop();
+      }
+    }
+  }
+  col.loop();
+}  // runTimings()
+
+
+/** send a code using the host functions and decode the envelope recorded by recordSend().
+ * @return true when the code is decoded from the envelope or cannot be sent.
+ */
+static bool checkSend(SignalParser *sig, SignalParser *check, const std::string &code) {
+  static SignalParser::CodeTime envelope[2 * SC_BUFFERSIZE];
+  char protName[PROTNAME_LEN];
+
+  snprintf(protName, sizeof(protName), "%s", code.substr(0, code.find(' ')).c_str());
+  if (sig->getSendRepeat(protName) == 0) {
+    return (true);  // e.g. fingerprints
+  }
+
+  col.recordSend(envelope, 2 * SC_BUFFERSIZE);
+  col.send(code.c_str());
+
+  // the receiver of the capture stretches the marks by the trim the envelope was composed with.
+  int trim = sig->getTrim(protName);
+  sentDecoded[0] = NUL;
+  for (int n = 0; envelope[n]; n++) {
+    long t = (long)envelope[n] + ((n % 2) ? -trim : trim);
+    check->parse(SignalParser::toCodeTime(t < 1 ? 1 : t));
+  }
+  check->flush();
+  return (code == sentDecoded);
+}  // checkSend()
+
+
+/** parse all timings of a capture by a single parse() call of a new parser.
+ * The decoded codes must be the same as when parsing the timings one by one.
+ * @return true when the same codes are decoded.
+ */
+static bool checkBlock(const std::vector<SignalParser::CodeTime> &timings, const std::string &protNames, bool trimLearn, const std::string &name) {
+  std::vector<std::string> codes;
+  blockDecoded = &codes;
+
+  SignalParser *sig = new SignalParser();
+  loadProtocols(sig, protNames);
+  sig->learnTrim(trimLearn);
+  sig->attachCallback(receiveBlock);
+  sig->parse(timings.data(), timings.size());
+  sig->flush();
+  delete sig;
+  blockDecoded = nullptr;
+
+  bool ok = (codes == decoded);
+  if (!ok) {
+    printf("FAIL %s: parsing in one block decoded %d codes instead of %d\n", name.c_str(), (int)codes.size(), (int)decoded.size());
+  }
+  return (ok);
+}  // checkBlock()
+
+
+/** classify the timings using all supported kernels and compare the masks with the scalar kernel.
+ * The windows are the start windows of the loaded protocols and some edge cases,
+ * the timings are the capture followed by the limits of the windows.
+ * @return true when all kernels create the same masks.
+ */
+static bool checkKernels(SignalParser *sig, const std::vector<SignalParser::CodeTime> &timings, const std::string &name) {
+  static const SignalParser::CodeTime edges[][2] = {
+    { 0, 0 }, { 0, SP_MAXTIME }, { SP_MAXTIME, SP_MAXTIME }, { 1000, 999 }  // the last one is empty
+  };
+  SignalParser::CodeTime minTime[SCL_WINDOWS];
+  SignalParser::CodeTime maxTime[SCL_WINDOWS];
+  int windows = 0;
+
+  for (auto &e : edges) {
+    minTime[windows] = e[0];
+    maxTime[windows] = e[1];
+    windows++;
+  }
+  for (unsigned int n = 0; n < PROTOCOLS; n++) {
+    SignalParser::CodeTime lo[MAX_TIMELENGTH];
+    SignalParser::CodeTime hi[MAX_TIMELENGTH];
+    int len = sig->getStartWindows(protocols[n]->name, lo, hi, MAX_TIMELENGTH);
+    for (int i = 0; (i < len) && (windows < SCL_WINDOWS); i++) {
+      minTime[windows] = lo[i];
+      maxTime[windows] = hi[i];
+      windows++;
+    }
+  }  // for
+
+  std::vector<SignalParser::CodeTime> t = timings;
+  for (int n = 0; n < windows; n++) {
+    t.push_back(minTime[n]);
+    t.push_back(maxTime[n]);
+    t.push_back(minTime[n] - 1);
+    t.push_back(maxTime[n] + 1);
+  }
+  std::vector<uint16_t> expected(t.size());
+  std::vector<uint16_t> masks(t.size());
+
+  const char *selected = SignalClassifier::getKernel();
+  bool ok = true;
+
+  for (int w = 1; ok && (w <= windows); w++) {
+    SignalClassifier::useKernel("scalar");
+    SignalClassifier::classify(t.data(), t.size(), minTime, maxTime, w, expected.data());
+
+    for (unsigned int k = 1; ok && (k < KERNELS); k++) {
+      if (!SignalClassifier::useKernel(kernels[k])) {
+        continue;  // not supported by the cpu
+      }
+      // start at any offset so every timing is classified in the vector and the scalar part.
+      for (int offset = 0; ok && (offset < 16); offset++) {
+        int count = t.size() - offset;
+        SignalClassifier::classify(t.data() + offset, count, minTime, maxTime, w, masks.data());
+        for (int i = 0; ok && (i < count); i++) {
+          if (masks[i] != expected[offset + i]) {
+            printf("FAIL %s: kernel %s classifies timing %u with %d windows as %04x instead of %04x\n",
+                   name.c_str(), kernels[k], t[offset + i], w, masks[i], expected[offset + i]);
+            ok = false;
+          }
+        }  // for
+      }  // for
+    }  // for
+  }  // for
+
+  SignalClassifier::useKernel(selected);
+  return (ok);
+}  // checkKernels()
+
+
+/** run a corpus file and compare the decoded codes.
+ * @return true when the decoded codes are as expected.
+ */
+static bool runCorpus(const std::string &dir, const std::string &name, double *nsPerTiming) {
+  std::vector<SignalParser::CodeTime> timings;
+  std::string protNames;
+  bool trimLearn = false;
+  std::string goldenName = dir + "/" + name + ".golden";
+
+  if (!readCapture(dir + "/" + name + ".txt", timings, protNames, trimLearn) || timings.empty()) {
+    printf("FAIL %s: no timings\n", name.c_str());
+    return (false);
+  }
+
+  // a new parser with the protocols of the corpus.
+  decoded.clear();
+  long heapStart = heapUsed();
+  SignalParser *sig = new SignalParser();
+  col.init(sig, NO_PIN, NO_PIN);
+  loadProtocols(sig, protNames);
+  sig->learnTrim(trimLearn);
+  sig->attachCallback(receiveCode);
+  long heap = heapUsed() - heapStart;
+
+  // a parser decoding the sent envelopes.
+  SignalParser *check = new SignalParser();
+  for (unsigned int n = 0; n < PROTOCOLS; n++) {
+    check->load(protocols[n]);
+  }
+  check->attachCallback(receiveSent);
+
+  // decode once, the decoded codes are kept on the heap by the runner.
+  recording = true;
+  long heapDecode = heapUsed();
+  runTimings(timings);
+  sig->flush();
+  recording = false;
+  long heapCodes = heapUsed() - heapDecode;
+
+  // measure the time per timing with at least 1.000.000 timings, best of 3 runs.
+  // Parsing must not allocate any memory.
+  unsigned long allocStart = heapAllocations();
+  int repeat = 1 + 1000000 / timings.size();
+  double best = 0;
+  for (int run = 0; run < 3; run++) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; r++) {
+      runTimings(timings);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / ((double)repeat * timings.size());
+    if ((run == 0) || (ns < best)) {
+      best = ns;
+    }
+  }  // for
+  *nsPerTiming = best;
+  unsigned long allocations = heapAllocations() - allocStart;
+
+  bool ok = true;
+  for (size_t n = 0; n < decoded.size(); n++) {
+    if ((std::find(decoded.begin(), decoded.begin() + n, decoded[n]) == decoded.begin() + n)
+        && (!checkSend(sig, check, decoded[n]))) {
+      printf("FAIL %s: sent [%s] decoded as [%s]\n", name.c_str(), decoded[n].c_str(), sentDecoded);
+      ok = false;
+    }
+  }  // for
+
+  if (!checkBlock(timings, protNames, trimLearn, name)) {
+    ok = false;
+  }
+
+  if (!checkKernels(sig, timings, name)) {
+    ok = false;
+  }
+
+  // the protocol records are global and will be loaded again by the next parser.
+  delete check;
+  delete sig;
+  long leaked = heapUsed() - heapStart - heapCodes;
+  if (optUpdate) {
+    FILE *f = fopen(goldenName.c_str(), "w");
+    for (auto &code : decoded) {
+      fprintf(f, "%s\n", code.c_str());
+    }
+    fclose(f);
+
+  } else {
+    std::vector<std::string> golden;
+    if (!readLines(goldenName, golden)) {
+      printf("FAIL %s: no file %s\n", name.c_str(), goldenName.c_str());
+      return (false);
+    }
+
+    size_t len = (golden.size() > decoded.size()) ? golden.size() : decoded.size();
+    for (size_t n = 0; n < len; n++) {
+      const char *exp = (n < golden.size()) ? golden[n].c_str() : "";
+      const char *got = (n < decoded.size()) ? decoded[n].c_str() : "";
+      if (strcmp(exp, got) != 0) {
+        if (ok) {
+          printf("FAIL %s: decoded codes differ\n", name.c_str());
+        }
+        printf("  %3d exp [%s]\n      got [%s]\n", (int)n, exp, got);
+        ok = false;
+      }
+    }  // for
+  }
+
+#ifdef CR_HEAP
+  if (allocations > 0) {
+    printf("FAIL %s: %lu allocations while parsing\n", name.c_str(), allocations);
+    ok = false;
+  }
+  if (leaked != 0) {
+    printf("FAIL %s: %ld bytes not freed by the parser\n", name.c_str(), leaked);
+    ok = false;
+  }
+#endif
+
+  printf("%s %s: timings %d codes %d ns/timing %.1f heap %ld (%lu allocations while parsing)\n",
+         ok ? "ok  " : "FAIL", name.c_str(), (int)timings.size(), (int)decoded.size(), best, heap, allocations);
+  return (ok);
+}  // runCorpus()
+
+
+/** read the times of a previous run. */
+static double baselineTime(const std::vector<std::string> &baseline, const std::string &name) {
+  for (auto &line : baseline) {
+    char n[256];
+    double ns;
+    if ((sscanf(line.c_str(), "%255s %lf", n, &ns) == 2) && (name == n)) {
+      return (ns);
+    }
+  }
+  return (0);
+}  // baselineTime()
+
+
+int main(int argc, char **argv) {
+  const char *dirName = nullptr;
+
+  for (int n = 1; n < argc; n++) {
+    if (strcmp(argv[n], "--update") == 0) {
+      optUpdate = true;
+    } else if (strcmp(argv[n], "--block") == 0) {
+      optBlock = true;
+    } else if ((strcmp(argv[n], "--baseline") == 0) && (n + 1 < argc)) {
+      optBaseline = argv[++n];
+    } else if ((strcmp(argv[n], "--save") == 0) && (n + 1 < argc)) {
+      optSave = argv[++n];
+    } else if ((strcmp(argv[n], "--threshold") == 0) && (n + 1 < argc)) {
+      optThreshold = atoi(argv[++n]);
+    } else if ((strcmp(argv[n], "--kernel") == 0) && (n + 1 < argc)) {
+      optKernel = argv[++n];
+    } else if (argv[n][0] != '-') {
+      dirName = argv[n];
+    } else {
+      dirName = nullptr;
+      break;
+    }
+  }  // for
+
+  if (!dirName) {
+    printf("usage: corpus_runner [--update] [--block] [--kernel name] [--baseline file] [--save file] [--threshold percent] directory\n");
+    return (2);
+  }
+
+  if (!SignalClassifier::useKernel(optKernel)) {
+    printf("kernel %s not supported\n", optKernel);
+    return (2);
+  }
+  printf("kernel %s\n", SignalClassifier::getKernel());
+
+  // find all captures
+  std::vector<std::string> names;
+  DIR *dir = opendir(dirName);
+  if (!dir) {
+    printf("directory %s not found\n", dirName);
+    return (2);
+  }
+  struct dirent *e;
+  while ((e = readdir(dir))) {
+    std::string f = e->d_name;
+    if ((f.length() > 4) && (f.compare(f.length() - 4, 4, ".txt") == 0)) {
+      names.push_back(f.substr(0, f.length() - 4));
+    }
+  }
+  closedir(dir);
+  std::sort(names.begin(), names.end());
+
+  std::vector<std::string> baseline;
+  if (optBaseline && !readLines(optBaseline, baseline)) {
+    printf("baseline %s not found\n", optBaseline);
+    return (2);
+  }
+
+  FILE *save = optSave ? fopen(optSave, "w") : nullptr;
+  int failed = 0;
+
+  for (auto &name : names) {
+    double ns = 0;
+    if (!runCorpus(dirName, name, &ns)) {
+      failed++;
+    }
+
+    double base = baselineTime(baseline, name);
+    if ((base > 0) && (ns > base * (100 + optThreshold) / 100)) {
+      printf("FAIL %s: %.1f ns/timing is more than %d%% slower than %.1f\n", name.c_str(), ns, optThreshold, base);
+      failed++;
+    }
+    if (save) {
+      fprintf(save, "%s %.1f\n", name.c_str(), ns);
+    }
+  }  // for
+
+  if (save) {
+    fclose(save);
+  }
+
+  printf("%d of %d captures failed\n", failed, (int)names.size());
+  return (failed ? 1 : 0);
+}  // main()
+
+// End.
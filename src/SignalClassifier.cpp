@@ -0,0 +1,185 @@
+/**
+ * @file SignalClassifier.cpp
+ *
+ * This file is part of the RFCodes library that implements receiving an sending
+ * RF and IR protocols.
+ *
+ * @copyright Copyright (c) by Matthias Hertel, https://www.mathertel.de.
+ *
+ * This work is licensed under a BSD 3-Clause style license,
+ * https://www.mathertel.de/License.aspx.
+ *
+ * @brief
+ * Classify a block of timings against up to 16 timing windows at once.
+ *
+ * Change History see SignalClassifier.h
+ */
+
+#include <Arduino.h>
+
+#include "SignalClassifier.h"
+
+#if defined(__GNUC__) && defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#define SCL_X86
+#include <immintrin.h>
+#endif
+
+typedef SignalParser::CodeTime CodeTime;
+
+typedef void (*KernelFunction)(const CodeTime *timings, int count,
+                               const CodeTime *minTime, const CodeTime *maxTime, int windows, uint16_t *masks);
+
+
+// ===== kernels =====
+
+
+/** classify one timing after the other. */
+static void classifyScalar(const CodeTime *timings, int count,
+                           const CodeTime *minTime, const CodeTime *maxTime, int windows, uint16_t *masks) {
+  for (int i = 0; i < count; i++) {
+    CodeTime t = timings[i];
+    uint16_t m = 0;
+    for (int n = 0; n < windows; n++) {
+      if ((t >= minTime[n]) && (t <= maxTime[n])) {
+        m |= (1 << n);
+      }
+    }
+    masks[i] = m;
+  }  // for
+}  // classifyScalar()
+
+
+#ifdef SCL_X86
+
+// A timing t is inside the window when both saturating differences (min - t) and (t - max) are 0.
+
+/** classify 8 timings at once using SSE2. */
+static void classifySSE2(const CodeTime *timings, int count,
+                         const CodeTime *minTime, const CodeTime *maxTime, int windows, uint16_t *masks) {
+  const __m128i zero = _mm_setzero_si128();
+  int i = 0;
+
+  for (; i + 8 <= count; i += 8) {
+    __m128i t = _mm_loadu_si128((const __m128i *)(timings + i));
+    __m128i m = zero;
+
+    for (int n = 0; n < windows; n++) {
+      __m128i below = _mm_subs_epu16(_mm_set1_epi16(minTime[n]), t);
+      __m128i above = _mm_subs_epu16(t, _mm_set1_epi16(maxTime[n]));
+      __m128i inside = _mm_cmpeq_epi16(_mm_or_si128(below, above), zero);
+      m = _mm_or_si128(m, _mm_and_si128(inside, _mm_set1_epi16((short)(1 << n))));
+    }
+    _mm_storeu_si128((__m128i *)(masks + i), m);
+  }  // for
+
+  classifyScalar(timings + i, count - i, minTime, maxTime, windows, masks + i);
+}  // classifySSE2()
+
+
+/** classify 16 timings at once using AVX2. */
+__attribute__((target("avx2"))) static void classifyAVX2(const CodeTime *timings, int count,
+                                                         const CodeTime *minTime, const CodeTime *maxTime, int windows,
+                                                         uint16_t *masks) {
+  const __m256i zero = _mm256_setzero_si256();
+  int i = 0;
+
+  for (; i + 16 <= count; i += 16) {
+    __m256i t = _mm256_loadu_si256((const __m256i *)(timings + i));
+    __m256i m = zero;
+
+    for (int n = 0; n < windows; n++) {
+      __m256i below = _mm256_subs_epu16(_mm256_set1_epi16(minTime[n]), t);
+      __m256i above = _mm256_subs_epu16(t, _mm256_set1_epi16(maxTime[n]));
+      __m256i inside = _mm256_cmpeq_epi16(_mm256_or_si256(below, above), zero);
+      m = _mm256_or_si256(m, _mm256_and_si256(inside, _mm256_set1_epi16((short)(1 << n))));
+    }
+    _mm256_storeu_si256((__m256i *)(masks + i), m);
+  }  // for
+
+  classifySSE2(timings + i, count - i, minTime, maxTime, windows, masks + i);
+}  // classifyAVX2()
+
+#endif
+
+
+// ===== kernel selection =====
+
+struct Kernel {
+  const char *name;
+  KernelFunction func;
+};
+
+// ordered by the speed measured by the corpus runner, the first supported kernel is used.
+static const Kernel kernels[] = {
+#ifdef SCL_X86
+  { "sse2", classifySSE2 },
+  { "avx2", classifyAVX2 },
+#endif
+  { "scalar", classifyScalar }
+};
+#define KERNELS (sizeof(kernels) / sizeof(kernels[0]))
+
+
+/** return true when the cpu supports the kernel. */
+static bool isSupported(const Kernel *k) {
+#ifdef SCL_X86
+  if (k->func == classifyAVX2) {
+    __builtin_cpu_init();
+    return (__builtin_cpu_supports("avx2"));
+  }
+#endif
+  return (true);
+}  // isSupported()
+
+
+/** return the fastest supported kernel. */
+static const Kernel *bestKernel() {
+  for (unsigned int n = 0; n < KERNELS; n++) {
+    if (isSupported(&kernels[n])) {
+      return (&kernels[n]);
+    }
+  }
+  return (&kernels[KERNELS - 1]);
+}  // bestKernel()
+
+
+// selected once at startup.
+static const Kernel *_kernel = bestKernel();
+
+
+// ===== public functions =====
+
+
+/** Classify timings against the windows minTime[n]...maxTime[n]. */
+void SignalClassifier::classify(const CodeTime *timings, int count,
+                                const CodeTime *minTime, const CodeTime *maxTime, int windows, uint16_t *masks) {
+  if (windows > SCL_WINDOWS) {
+    windows = SCL_WINDOWS;
+  }
+  _kernel->func(timings, count, minTime, maxTime, windows, masks);
+}  // classify()
+
+
+/** Use a kernel by name or the fastest supported kernel for nullptr. */
+bool SignalClassifier::useKernel(const char *name) {
+  if (!name) {
+    _kernel = bestKernel();
+    return (true);
+  }
+
+  for (unsigned int n = 0; n < KERNELS; n++) {
+    if ((strcmp(name, kernels[n].name) == 0) && isSupported(&kernels[n])) {
+      _kernel = &kernels[n];
+      return (true);
+    }
+  }
+  return (false);
+}  // useKernel()
+
+
+/** Return the name of the kernel in use. */
+const char *SignalClassifier::getKernel() {
+  return (_kernel->name);
+}  // getKernel()
+
+// End.
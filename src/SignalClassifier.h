@@ -0,0 +1,59 @@
+/**
+ * @file: SignalClassifier.h
+ *
+ * This file is part of the RFCodes library that implements receiving an sending
+ * RF and IR protocols.
+ *
+ * @copyright Copyright (c) by Matthias Hertel, https://www.mathertel.de.
+ *
+ * This work is licensed under a BSD 3-Clause style license,
+ * https://www.mathertel.de/License.aspx.
+ *
+ * @brief
+ * Classify a block of timings against up to 16 timing windows at once.
+ * For every timing a bit mask is created with bit n set when the timing is inside window n.
+ * On x86 hosts the SSE2 kernel is used, on other platforms a scalar kernel is used.
+ * The AVX2 kernel can be selected by useKernel() but was not faster with the few windows in use.
+ *
+ * The SignalParser uses it as the start prefilter of block parsing with one window per protocol
+ * covering the first timing of its start codes.
+ * The code windows of a protocol that is receiving are not classified here.
+ *
+ * Changelog:
+ * * 18.10.2026 created by agent
+ * * 18.10.2026 documented as the start prefilter
+ * * 18.10.2026 the kernels are ordered by the measured speed.
+ */
+
+#ifndef SignalClassifier_H_
+#define SignalClassifier_H_
+
+#include "SignalParser.h"
+
+#define SCL_WINDOWS 16  // maximal number of windows, one bit per window in the masks
+
+class SignalClassifier {
+public:
+  /**
+   * @brief Classify timings against the windows minTime[n]...maxTime[n].
+   * @param timings The timings to classify.
+   * @param count The number of timings.
+   * @param minTime The minimal timings of the windows.
+   * @param maxTime The maximal timings of the windows.
+   * @param windows The number of windows, up to SCL_WINDOWS.
+   * @param masks target buffer for count masks.
+   */
+  static void classify(const SignalParser::CodeTime *timings, int count,
+                       const SignalParser::CodeTime *minTime, const SignalParser::CodeTime *maxTime, int windows,
+                       uint16_t *masks);
+
+  /** Use a kernel by name ("scalar", "sse2", "avx2") or the fastest supported kernel for nullptr.
+   * @return false when the kernel is not supported.
+   */
+  static bool useKernel(const char *name = nullptr);
+
+  /** Return the name of the kernel in use. */
+  static const char *getKernel();
+};  // class SignalClassifier
+
+#endif  // SignalClassifier_H_
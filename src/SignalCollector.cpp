@@ -13,6 +13,11 @@
 
 #include "SignalCollector.h"
 
+#if !defined(ESP32) && !defined(ARDUINO)
+// host environment
+#include <thread>
+#endif
+
 // ====== SignalCollector implemenation =====
 
 /**
@@ -21,12 +26,17 @@
  * receiving mode.
  * @param sendPin The IO pin to be used for sending. Set to -1 to disable
  * sending mode.
+ * @param trim The time in µsecs marks are received longer than spaces.
  */
 void SignalCollector::init(SignalParser *sig, int recvPin, int sendPin, int trim)
 {
   TRACE_MSG("Initalizing tabRF hardware\n");
 
   _sig = sig;
+  if (trim) {
+    // the trim is applied by the parser.
+    _sig->setTrim(trim);
+  }
 
   // Receiving mode
   _recvPin = recvPin;
@@ -67,6 +77,74 @@ void strcpyProtname(char *target, const char *signal)
 } // strcpyProtname
 
 
+// start the carrier modulation when supported by the hardware.
+void SignalCollector::_carrierBegin(unsigned int frequency, unsigned int dutyCycle)
+{
+  _carrier = frequency;
+  _carrierDuty = (dutyCycle * 255) / 100;
+
+  if ((_carrier) && (_sendPin >= 0)) {
+#if defined(ESP32) && defined(ESP_ARDUINO_VERSION_MAJOR) && (ESP_ARDUINO_VERSION_MAJOR >= 3)
+    ledcAttach(_sendPin, _carrier, 8);
+#elif defined(ESP32)
+    ledcSetup(SC_LEDC_CHANNEL, _carrier, 8);
+    ledcAttachPin(_sendPin, SC_LEDC_CHANNEL);
+#else
+    // no carrier hardware, only the envelope is sent.
+    // The PWM of the ESP8266 is generated in software by a timer interrupt
+    // and interrupts are disabled while sending.
+    _carrier = 0;
+#endif
+    _sendLevel(LOW);
+  }
+} // _carrierBegin()
+
+
+// stop the carrier modulation.
+void SignalCollector::_carrierEnd()
+{
+  if ((_carrier) && (_sendPin >= 0)) {
+    _sendLevel(LOW);
+#if defined(ESP32) && defined(ESP_ARDUINO_VERSION_MAJOR) && (ESP_ARDUINO_VERSION_MAJOR >= 3)
+    ledcDetach(_sendPin);
+#elif defined(ESP32)
+    ledcDetachPin(_sendPin);
+#endif
+    pinMode(_sendPin, OUTPUT);
+  }
+  _carrier = 0;
+} // _carrierEnd()
+
+
+// set the output level or switch the carrier and record the duration since the last change.
+void SignalCollector::_sendLevel(int level)
+{
+  if (_sendPin < 0) {
+    // recording only.
+
+  } else if (_carrier) {
+#if defined(ESP32) && defined(ESP_ARDUINO_VERSION_MAJOR) && (ESP_ARDUINO_VERSION_MAJOR >= 3)
+    ledcWrite(_sendPin, level ? _carrierDuty : 0);
+#elif defined(ESP32)
+    ledcWrite(SC_LEDC_CHANNEL, level ? _carrierDuty : 0);
+#endif
+
+  } else {
+    digitalWrite(_sendPin, level);
+  }
+
+  if (_sendRecordEnd) {
+    // the envelope starts with the first mark.
+    unsigned long now = micros();
+    if ((_sendRecordStarted) && (_sendRecord < _sendRecordEnd)) {
+      *_sendRecord++ = SignalParser::toCodeTime(now - _sendRecordTime);
+    }
+    _sendRecordStarted = _sendRecordStarted || level;
+    _sendRecordTime = now;
+  }
+} // _sendLevel()
+
+
 void SignalCollector::send(const char *signal)
 {
   SignalParser::CodeTime timings[256];
@@ -80,11 +158,21 @@ void SignalCollector::send(const char *signal)
   int repeat = _sig->getSendRepeat(protname);
   // INFO_MSG("send repeat %d", repeat);
 
-  if ((repeat) && (_sendPin >= 0)) {
+  if ((repeat) && ((_sendPin >= 0) || (_sendRecord))) {
     // get timings of the code
     _sig->compose(signal, timings, sizeof(timings) / sizeof(SignalParser::CodeTime));
     // dumpTimings(timings);
 
+    unsigned int dutyCycle = 0;
+    unsigned int carrier = _sig->getCarrier(protname, &dutyCycle);
+    _carrierBegin(carrier, dutyCycle);
+
+    if (_sendRecord) {
+      // keep space for the final 0.
+      _sendRecordEnd = _sendRecord + _sendRecordLen - 1;
+      _sendRecordStarted = false;
+    }
+
     while (repeat) {
       SignalParser::CodeTime *t = timings;
 
@@ -94,7 +182,7 @@ void SignalCollector::send(const char *signal)
 
       while (*t) {
         level = !level;
-        digitalWrite(_sendPin, level);
+        _sendLevel(level);
         delayMicroseconds(*t++);
       } // while
 
@@ -105,30 +193,349 @@ void SignalCollector::send(const char *signal)
       repeat--;
     } // while
     
-    // never leave active after sending.
-    digitalWrite(_sendPin, LOW);
+    // never leave active after sending, this also records the last duration.
+    _sendLevel(LOW);
+    if (_sendRecordEnd) {
+      *_sendRecord = 0;
+      _sendRecord = nullptr;
+      _sendRecordEnd = nullptr;
+    }
+
+    _carrierEnd();
+    if (_sendPin >= 0) {
+      digitalWrite(_sendPin, LOW);
+    }
 
   } // if
 } // send()
 
 
 // process bytes from ring buffer
-void SignalCollector::loop()
+void SignalCollector::_parseBuffer()
 {
-  while (SignalCollector::buf88_cnt > 0) {
-    SignalParser::CodeTime t = *SignalCollector::buf88_read++;
-    SignalCollector::buf88_cnt--;
+  SignalParser::CodeTime *r = SignalCollector::buf88_read.load(std::memory_order_relaxed);
 
-    _sig->parse(t);
+  while (r != SignalCollector::ringWrite.load(std::memory_order_acquire)) {
+    SignalParser::CodeTime t = *r++;
 
     // reset pointer to the start when reaching end
-    if (SignalCollector::buf88_read == SignalCollector::buf88_end)
-      SignalCollector::buf88_read = SignalCollector::buf88;
+    if (r == SignalCollector::buf88_end)
+      r = SignalCollector::buf88;
+    SignalCollector::buf88_read.store(r, std::memory_order_release);
+
+    _sig->parse(t);
+    _dispatchFull();
+    if ((_sig->getPosition() % 64) == 0) {
+      _releaseTimings();
+    }
     yield();
   } // while
+  _releaseTimings();
+} // _parseBuffer()
+
+
+// pass the codes queued by the parser before the queue overflows.
+// A ring buffer full of timings holds more sequences than the queue so the codes are passed
+// while parsing when the queue is half full. In pipelined mode loop() passes the codes.
+void SignalCollector::_dispatchFull()
+{
+  SignalQueue *q = _sig->getQueue();
+  if ((q) && (!_pipelineActive) && (q->getCount() >= SQ_CAPACITY / 2)) {
+    _sig->dispatch();
+  }
+} // _dispatchFull()
+
+
+// release the parsed timings that are not part of a sequence any more.
+void SignalCollector::_releaseTimings()
+{
+  unsigned long pos = _sig->getPosition();
+
+  if (!_keepTimings) {
+    // nothing is kept.
+    _keepPosition = pos;
+
+  } else {
+    // the kept timings are only moved forward.
+    unsigned long oldest = _sig->getOldestPosition();
+    if ((long)(oldest - _keepPosition) > 0)
+      _keepPosition = oldest;
+    if (pos - _keepPosition > SC_KEEPSIZE)
+      _keepPosition = pos - SC_KEEPSIZE;
+  }
+
+  SignalParser::CodeTime *k = SignalCollector::buf88_read.load(std::memory_order_relaxed) - (pos - _keepPosition);
+  if (k < SignalCollector::buf88)
+    k += SC_BUFFERSIZE;
+  SignalCollector::ringKeep.store(k, std::memory_order_release);
+} // _releaseTimings()
+
+
+/** Use a receive backend that delivers blocks of timings. */
+bool SignalCollector::attachReceiver(SignalReceiver *receiver)
+{
+  if (_receiver) {
+    _receiver->end();
+  }
+  _receiver = nullptr;
+
+  if ((receiver) && (receiver->begin())) {
+    _receiver = receiver;
+  }
+  return (_receiver != nullptr);
+} // attachReceiver()
+
+
+/** Pass a block of timings from a receive backend directly to the parser. */
+void SignalCollector::receiveTimings(const SignalParser::CodeTime *timings, int count)
+{
+  if (_captureState) {
+    for (int n = 0; n < count; n++) {
+      _captureTiming(timings[n]);
+    }
+  }
+  SignalCollector::lastTime = micros();
+
+  // keep the order with timings from the ring buffer.
+  _parseBuffer();
+
+  // large blocks are parsed in parts so the queued codes can be passed in between.
+  while (count > 0) {
+    int len = (count < SC_DISPATCHSTEP) ? count : SC_DISPATCHSTEP;
+    _blockParse = true;
+    _sig->parse(timings, len);
+    _blockParse = false;
+    _dispatchFull();
+    timings += len;
+    count -= len;
+  } // while
+
+  // the timings of the block are not in the ring buffer.
+  _keepPosition = _sig->getPosition();
+  _releaseTimings();
+} // receiveTimings()
+
+
+// finish the sequences when the idle timeout is reached.
+void SignalCollector::_checkIdle()
+{
+  if (_idleTimeout) {
+    unsigned long last = SignalCollector::lastTime;
+    unsigned long idle = micros() - last;
+
+    // only once after the last signal change and when all timings are parsed.
+    if ((idle > _idleTimeout) && (last != _idleTime) && (getBufferCount() == 0)) {
+      _idleTime = last;
+      if (_sig->flush()) {
+        if (idle > _maxIdleLatency)
+          _maxIdleLatency = idle;
+      }
+    }
+  }
+} // _checkIdle()
+
+
+// parse the received timings or dispatch the decoded codes in pipelined mode.
+void SignalCollector::loop()
+{
+  if (!_pipelineActive) {
+    if (_receiver)
+      _receiver->poll(this);
+    _parseBuffer();
+    _checkIdle();
+  }
+  // pass the codes from the queue when used after the batch of timings.
+  _sig->dispatch();
 } // loop
 
 
+// This function is running in the task or thread of the pipelined mode.
+void SignalCollector::_pipelineTask(void *arg)
+{
+  SignalCollector *col = (SignalCollector *)arg;
+
+  while (col->_pipelineActive) {
+    if (col->_receiver)
+      col->_receiver->poll(col);
+    col->_parseBuffer();
+    col->_checkIdle();
+#if defined(ESP32)
+    vTaskDelay(1);
+#elif !defined(ARDUINO)
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+#endif
+  } // while
+
+#if defined(ESP32)
+  // stopPipeline() waits for this store.
+  col->_pipelineHandle.store(nullptr, std::memory_order_release);
+  vTaskDelete(NULL);
+#endif
+} // _pipelineTask()
+
+
+/** Start the pipelined mode. */
+bool SignalCollector::startPipeline(SignalQueue *queue, int core)
+{
+  if (_pipelineActive || !queue)
+    return (false);
+
+  _parserQueue = _sig->getQueue();
+  _sig->attachQueue(queue);
+  _sig->lockChanges(true);
+  _pipelineActive = true;
+
+#if defined(ESP32)
+  TaskHandle_t handle = NULL;
+  if (xTaskCreatePinnedToCore(_pipelineTask, "RFCodes", 4096, this, 1, &handle, core) == pdPASS) {
+    _pipelineHandle.store(handle, std::memory_order_release);
+  }
+#elif !defined(ARDUINO)
+  (void)core;
+  _pipelineHandle.store(new std::thread(_pipelineTask, this), std::memory_order_release);
+#else
+  (void)core; // no tasks available.
+#endif
+
+  if (!_pipelineHandle.load(std::memory_order_acquire)) {
+    _pipelineActive = false;
+    _sig->lockChanges(false);
+    _sig->attachQueue(_parserQueue);
+  }
+  return (_pipelineActive);
+} // startPipeline()
+
+
+/** Stop the pipelined mode. */
+void SignalCollector::stopPipeline()
+{
+  if (_pipelineActive) {
+    _pipelineActive = false;
+
+#if defined(ESP32)
+    while (_pipelineHandle.load(std::memory_order_acquire)) {
+      delay(1);
+    }
+#elif !defined(ARDUINO)
+    std::thread *thread = (std::thread *)_pipelineHandle.load(std::memory_order_acquire);
+    thread->join();
+    delete thread;
+    _pipelineHandle.store(nullptr, std::memory_order_release);
+#endif
+
+    // pass the remaining codes and use the previous queue or callback again.
+    _sig->dispatch();
+    _sig->attachQueue(_parserQueue);
+    _sig->lockChanges(false);
+  } // if
+} // stopPipeline()
+
+
+// ===== Capture mode =====
+
+
+/** Add a capture trigger matching a duration in the range minTime...maxTime. */
+int SignalCollector::addTrigger(SignalParser::CodeTime minTime, SignalParser::CodeTime maxTime)
+{
+  return (addTrigger(&minTime, &maxTime, 1));
+} // addTrigger()
+
+
+/** Add a capture trigger matching a pattern of len durations in a row. */
+int SignalCollector::addTrigger(const SignalParser::CodeTime *minTime, const SignalParser::CodeTime *maxTime, int len)
+{
+  if ((_triggerCount >= SC_TRIGGERS) || (len < 1) || (len > SC_TRIGGERLEN)
+      || (_captureState == SC_CAPTURE_ARMED) || (_captureState == SC_CAPTURE_RECORD)) {
+    return (-1);
+  }
+
+  Trigger *tr = &_triggers[_triggerCount];
+  for (int n = 0; n < len; n++) {
+    tr->minTime[n] = minTime[n];
+    tr->maxTime[n] = maxTime[n];
+  }
+  tr->length = len;
+  tr->matched = 0;
+  return (_triggerCount++);
+} // addTrigger()
+
+
+/** Add a capture trigger matching the start code of a loaded protocol. */
+int SignalCollector::addTrigger(const char *protocolName)
+{
+  SignalParser::CodeTime minTime[SC_TRIGGERLEN];
+  SignalParser::CodeTime maxTime[SC_TRIGGERLEN];
+
+  int len = _sig->getStartWindows(protocolName, minTime, maxTime, SC_TRIGGERLEN);
+  return (len ? addTrigger(minTime, maxTime, len) : -1);
+} // addTrigger()
+
+
+// Remove all capture triggers.
+void SignalCollector::clearTriggers()
+{
+  stopCapture();
+  _triggerCount = 0;
+} // clearTriggers()
+
+
+/** Start capturing all received timings into the buffer. */
+bool SignalCollector::startCapture(SignalParser::CodeTime *buffer, int len, int preTrigger)
+{
+  stopCapture();
+
+  if ((!buffer) || (len < 1) || (preTrigger < 1) || (preTrigger > len) || (!_triggerCount)) {
+    return (false);
+  }
+
+  for (int n = 0; n < _triggerCount; n++) {
+    _triggers[n].matched = 0;
+  }
+  _captureBuffer = buffer;
+  _captureSize = len;
+  _capturePre = preTrigger;
+  _capturePos = 0;
+  _captureCount = 0;
+  _captureTrigger = -1;
+  _captureState = SC_CAPTURE_ARMED; // the ISR starts capturing now
+  return (true);
+} // startCapture()
+
+
+// Stop capturing.
+void SignalCollector::stopCapture()
+{
+  _captureState = SC_CAPTURE_OFF;
+} // stopCapture()
+
+
+/** Return the captured timings without copying when the capture is done. */
+int SignalCollector::getCapture(TimingSpan *span)
+{
+  span->first = span->second = nullptr;
+  span->firstLength = span->secondLength = 0;
+
+  if (_captureState != SC_CAPTURE_DONE) {
+    return (-1);
+  }
+
+  // the captured timings end before the write position.
+  int len = _captureCount;
+  int start = _capturePos - len;
+  if (start < 0)
+    start += _captureSize;
+
+  int n = _captureSize - start;
+  span->first = _captureBuffer + start;
+  span->firstLength = (len < n) ? len : n;
+  if (len > n) {
+    span->second = _captureBuffer;
+    span->secondLength = len - n;
+  }
+  return (len - (_captureSize - _capturePre) - 1);
+} // getCapture()
+
+
 // ===== Insights and Debugging Helpers =====
 
 
@@ -139,7 +546,7 @@ void SignalCollector::getBufferData(SignalParser::CodeTime *buffer, int len)
   if (len > SC_BUFFERSIZE)
     len = SC_BUFFERSIZE;
 
-  SignalParser::CodeTime *p = (SignalParser::CodeTime *)buf88_read - len;
+  SignalParser::CodeTime *p = buf88_read.load() - len;
   if (p < buf88)
     p += SC_BUFFERSIZE;
 
@@ -156,6 +563,35 @@ void SignalCollector::getBufferData(SignalParser::CodeTime *buffer, int len)
 }; // getBufferData()
 
 
+/** Return the timings of the code sequence passed to the callback function without copying. */
+bool SignalCollector::getFrameTimings(TimingSpan *span)
+{
+  int len = _sig->getFrameLength();
+  unsigned long back = _sig->getPosition() - _sig->getFrameStart(); // timings from the start to the read pointer
+  unsigned long kept = _sig->getPosition() - _keepPosition;
+
+  span->first = span->second = nullptr;
+  span->firstLength = span->secondLength = 0;
+
+  if ((len <= 0) || (!_keepTimings) || _pipelineActive || _blockParse || (back > kept)) {
+    return (false);
+  }
+
+  SignalParser::CodeTime *p = buf88_read.load(std::memory_order_relaxed) - back;
+  if (p < buf88)
+    p += SC_BUFFERSIZE;
+
+  int n = buf88_end - p;
+  span->first = p;
+  span->firstLength = (len < n) ? len : n;
+  if (len > n) {
+    span->second = buf88;
+    span->secondLength = len - n;
+  }
+  return (true);
+} // getFrameTimings()
+
+
 /** dump the data from a table of timings that end with a 0 time. */
 void SignalCollector::dumpTimings(SignalParser::CodeTime *raw)
 {
@@ -177,47 +613,123 @@ void SignalCollector::dumpTimings(SignalParser::CodeTime *raw)
 } // dumpTimings
 
 
+/** dump the timings of a sequence. */
+void SignalCollector::dumpTimings(const TimingSpan *span)
+{
+  int len = 0;
+  for (int s = 0; s < 2; s++) {
+    const SignalParser::CodeTime *p = (s ? span->second : span->first);
+    int cnt = (s ? span->secondLength : span->firstLength);
+    while (cnt--) {
+      if (len % 8 == 0) {
+        RAW_MSG("%3d: %5u,", len, *p);
+      } else if (len % 8 == 7) {
+        RAW_MSG(" %5u,\n", *p);
+      } else {
+        RAW_MSG(" %5u,", *p);
+      }
+      p++;
+      len++;
+    } // while
+  } // for
+  RAW_MSG("\n");
+} // dumpTimings
+
+
 // static class stuff, to be accessible to the Interrupt service routines.
 
 // This handler is attached to the change interrupt.
 void IRAM_ATTR SignalCollector::signal_change_handler()
 {
   unsigned long now = micros();
-  SignalParser::CodeTime t = (SignalParser::CodeTime)(now - SignalCollector::lastTime);
-
-  // // adjust the timing with the trim factor.
-  // int level = digitalRead(_recvPin);
-  // if (level) {
-  //   t += SignalCollector::_trim; // end of low
-  // } else {
-  //   t -= SignalCollector::_trim; // end of high
-  // }
+  SignalParser::CodeTime t = SignalParser::toCodeTime(now - SignalCollector::lastTime);
 
   // write to ring buffer
-  if (SignalCollector::buf88_cnt < SC_BUFFERSIZE) {
-    *SignalCollector::ringWrite++ = t;
-    buf88_cnt++;
+  SignalParser::CodeTime *w = SignalCollector::ringWrite.load(std::memory_order_relaxed);
+  SignalParser::CodeTime *next = w + 1;
 
-    // reset pointer to the start when reaching end
-    if (SignalCollector::ringWrite == SignalCollector::buf88_end)
-      SignalCollector::ringWrite = SignalCollector::buf88;
+  // reset pointer to the start when reaching end
+  if (next == SignalCollector::buf88_end)
+    next = SignalCollector::buf88;
+
+  if (_captureState) {
+    _captureTiming(t);
+  }
+
+  if (next != SignalCollector::ringKeep.load(std::memory_order_acquire)) {
+    *w = t;
+    SignalCollector::ringWrite.store(next, std::memory_order_release);
+  } else {
+    buf88_dropped = buf88_dropped + 1;
   } // if
 
   lastTime = now; // micros();
 } // signal_change_handler()
 
 
+// capture a timing and check the triggers.
+void IRAM_ATTR SignalCollector::_captureTiming(SignalParser::CodeTime t)
+{
+  _captureBuffer[_capturePos] = t;
+  if (++_capturePos == _captureSize)
+    _capturePos = 0;
+  if (_captureCount < _captureSize)
+    _captureCount = _captureCount + 1;
+
+  if (_captureState == SC_CAPTURE_ARMED) {
+    for (int n = 0; n < _triggerCount; n++) {
+      Trigger *tr = &_triggers[n];
+
+      // bit k is set when the timing is inside window k.
+      uint32_t fits = 0;
+      for (int k = 0; k < tr->length; k++) {
+        if ((t >= tr->minTime[k]) && (t <= tr->maxTime[k]))
+          fits |= (1UL << k);
+      }
+
+      // every partial match continues with the next window, a new match may start at window 0.
+      uint32_t m = ((tr->matched << 1) | 1) & fits;
+
+      if (m & (1UL << (tr->length - 1))) {
+        _captureTrigger = n;
+        _capturePost = _captureSize - _capturePre;
+        _captureState = (_capturePost ? SC_CAPTURE_RECORD : SC_CAPTURE_DONE);
+        m = 0;
+      }
+      tr->matched = m;
+      if (_captureTrigger >= 0)
+        break;
+    } // for
+
+  } else if (_captureState == SC_CAPTURE_RECORD) {
+    _capturePost = _capturePost - 1;
+    if (_capturePost == 0) {
+      _captureState = SC_CAPTURE_DONE;
+    }
+  } // if
+} // _captureTiming()
+
+
 // Inject a test timing into the ring buffer.
-void SignalCollector::injectTiming(SignalParser::CodeTime t)
+void SignalCollector::injectTiming(unsigned long t)
 {
   // write to ring buffer
-  if (SignalCollector::buf88_cnt < SC_BUFFERSIZE) {
-    *SignalCollector::ringWrite++ = t;
-    buf88_cnt++;
+  SignalParser::CodeTime *w = SignalCollector::ringWrite.load(std::memory_order_relaxed);
+  SignalParser::CodeTime *next = w + 1;
 
-    // reset pointer to the start when reaching end
-    if (SignalCollector::ringWrite == SignalCollector::buf88_end)
-      SignalCollector::ringWrite = SignalCollector::buf88;
+  // reset pointer to the start when reaching end
+  if (next == SignalCollector::buf88_end)
+    next = SignalCollector::buf88;
+
+  if (_captureState) {
+    _captureTiming(SignalParser::toCodeTime(t));
+  }
+
+  if (next != SignalCollector::ringKeep.load(std::memory_order_acquire)) {
+    *w = SignalParser::toCodeTime(t);
+    SignalCollector::ringWrite.store(next, std::memory_order_release);
+  } else {
+    buf88_dropped = buf88_dropped + 1;
   } // if
 
   SignalCollector::lastTime = micros();
@@ -228,20 +740,36 @@ int SignalCollector::_recvPin = -1;
 
 // allocate and initialize the static class members.
 
-unsigned long SignalCollector::lastTime = 0;
+volatile unsigned long SignalCollector::lastTime = 0;
 
 // allocate memory for ring buffer
 SignalParser::CodeTime *SignalCollector::buf88 = (SignalParser::CodeTime *)malloc(SC_BUFFERSIZE * sizeof(SignalParser::CodeTime));
 
 // write pointer starts at start
-volatile SignalParser::CodeTime *SignalCollector::ringWrite = SignalCollector::buf88;
+std::atomic<SignalParser::CodeTime *> SignalCollector::ringWrite(SignalCollector::buf88);
 
 // read pointer starts at start
-volatile SignalParser::CodeTime *SignalCollector::buf88_read = SignalCollector::buf88;
+std::atomic<SignalParser::CodeTime *> SignalCollector::buf88_read(SignalCollector::buf88);
+
+// no timings are kept at start
+std::atomic<SignalParser::CodeTime *> SignalCollector::ringKeep(SignalCollector::buf88);
 
 // end of buffer + 1 pointer for wrapping
 SignalParser::CodeTime *SignalCollector::buf88_end = SignalCollector::buf88 + SC_BUFFERSIZE;
 
-volatile unsigned int SignalCollector::buf88_cnt = 0; // number of bytes in buffer
+volatile unsigned long SignalCollector::buf88_dropped = 0; // number of dropped timings
+
+// capture mode
+SignalCollector::Trigger SignalCollector::_triggers[SC_TRIGGERS];
+int SignalCollector::_triggerCount = 0;
+
+SignalParser::CodeTime *SignalCollector::_captureBuffer = nullptr;
+int SignalCollector::_captureSize = 0;
+int SignalCollector::_capturePre = 0;
+volatile int SignalCollector::_capturePos = 0;
+volatile int SignalCollector::_captureCount = 0;
+volatile int SignalCollector::_capturePost = 0;
+volatile int SignalCollector::_captureState = SC_CAPTURE_OFF;
+volatile int SignalCollector::_captureTrigger = -1;
 
 // End.
@@ -12,15 +12,29 @@
  * Changelog:
  * * 29.04.2018 created by Matthias Hertel
  * * 06.08.2018 const char send, allow for sending only.
+ * * 18.10.2026 optional pipelined mode parsing in a separate task or thread.
+ * * 18.10.2026 finish sequences after an idle timeout.
+ * * 18.10.2026 send using a hardware carrier for IR protocols.
+ * * 18.10.2026 timings of a received sequence without copying.
+ * * 18.10.2026 capture mode with triggers.
+ * * 18.10.2026 receive backends delivering blocks of timings.
+ * * 18.10.2026 the trim is applied by the parser.
+ * * 18.10.2026 recordSend() records the measured durations, no carrier on the ESP8266.
+ * * 18.10.2026 timings are only kept for getFrameTimings() after keepTimings().
+ * * 18.10.2026 pattern triggers track all partial matches.
+ * * 18.10.2026 the end of the pipeline task is signaled by an atomic handle.
  */
 
 #ifndef TabRF_H_
 #define TabRF_H_
 
 #include <Arduino.h>
+#include <atomic>
 
 #include "debugout.h"
 #include "SignalParser.h"
+#include "SignalQueue.h"
+#include "SignalReceiver.h"
 
 #define NUL '\0'
 #define null 0
@@ -29,7 +43,22 @@
 
 #define TabRF_ERR(...) Serial.printf("Error: " __VA_ARGS__)
 
-#define SC_BUFFERSIZE 512
+#define SC_BUFFERSIZE 1024
+
+#define SC_KEEPSIZE (SC_BUFFERSIZE / 2) // maximal number of parsed timings kept for the current sequences
+
+#define SC_DISPATCHSTEP 128 // number of timings of a block parsed before the queue of the parser is checked
+
+#define SC_LEDC_CHANNEL 0 // LEDC channel used for the carrier on ESP32 (core < 3.0)
+
+#define SC_TRIGGERS 4 // maximal number of capture triggers
+#define SC_TRIGGERLEN 8 // maximal number of durations in a trigger pattern
+
+// states of the capture mode
+#define SC_CAPTURE_OFF 0 // not capturing
+#define SC_CAPTURE_ARMED 1 // capturing the timings before a trigger and checking the triggers
+#define SC_CAPTURE_RECORD 2 // a trigger was found, capturing the timings after the trigger
+#define SC_CAPTURE_DONE 3 // the capture is complete
 
 // main class for the TabRF library
 class SignalCollector
@@ -40,14 +69,138 @@ public:
    * interrupt service routine.
    * @param recvPin
    * @param sendPin
+   * @param trim The time in µsecs marks are received longer than spaces, see SignalParser::setTrim().
    */
   void init(SignalParser *sig, int recvPin, int sendPin, int trim = 0);
 
+  /**
+   * @brief Use a receive backend that delivers blocks of timings instead of
+   * an interrupt for every signal change. Use NO_PIN as recvPin in init().
+   * @param receiver The backend or nullptr to stop using it.
+   * @return true when the backend was started.
+   */
+  bool attachReceiver(SignalReceiver *receiver);
+
+  /**
+   * @brief Pass a block of timings from a receive backend directly to the parser.
+   * This is called by the backends from loop() or the task of the pipelined mode.
+   * The timings of a received sequence are not available by getFrameTimings().
+   * @param timings The timings.
+   * @param count The number of timings.
+   */
+  void receiveTimings(const SignalParser::CodeTime *timings, int count);
+
   // send out a new code
+  // Protocols with a carrier frequency are modulated using the LEDC hardware (ESP32).
+  // On the ESP8266 the PWM is generated in software by a timer interrupt that is disabled while
+  // sending so only the envelope is sent like on all other platforms.
   void send(const char *code);
 
+  /** Record the envelope of the next send() call: the measured durations between the changes
+   * of the output or carrier of all repeats, terminated by a 0 timing.
+   * This works without a send pin to verify sending without hardware.
+   * @param buffer target timing buffer
+   * @param len length of buffer
+   */
+  void recordSend(SignalParser::CodeTime *buffer, int len)
+  {
+    _sendRecord = buffer;
+    _sendRecordLen = len;
+  };
+
+  // The timings of a received sequence in the ring buffer.
+  // The timings may wrap at the end of the ring buffer so there are 2 segments.
+  struct TimingSpan {
+    const SignalParser::CodeTime *first;
+    int firstLength;
+    const SignalParser::CodeTime *second;
+    int secondLength;
+  };
+
+  // parse the received timings and dispatch the queued codes.
+  // In pipelined mode only the queued codes are dispatched.
   void loop();
 
+  /**
+   * @brief Start the pipelined mode: the timings are parsed in a separate task
+   * (ESP32) or thread (host) and the decoded codes are passed through the queue.
+   * loop() then only passes the queued codes to the callback function.
+   * The parser is locked until stopPipeline() so protocols, subscriptions and the trim
+   * cannot be changed while the task or thread is parsing, see SignalParser::lockChanges().
+   * @param queue The queue for the decoded codes.
+   * @param core The core the parsing task is pinned to (ESP32 only).
+   * @return true when the pipelined mode is supported and started.
+   */
+  bool startPipeline(SignalQueue *queue, int core = 0);
+
+  // Stop the pipelined mode and parse in loop() again.
+  void stopPipeline();
+
+  /**
+   * @brief Set the idle timeout. When no signal change was received for this time
+   * all started sequences with at least minCodeLen codes are finished.
+   * This is required for protocols with a variable length and without an end code.
+   * @param timeout The timeout in µsecs, 0 to disable.
+   */
+  void setIdleTimeout(unsigned long timeout)
+  {
+    _idleTimeout = timeout;
+  };
+
+  // ===== Capture mode =====
+
+  /** Add a capture trigger matching a duration in the range minTime...maxTime.
+   * Triggers can only be added while not capturing.
+   * @return index of the trigger or -1 when no more triggers are available.
+   */
+  int addTrigger(SignalParser::CodeTime minTime, SignalParser::CodeTime maxTime);
+
+  /** Add a capture trigger matching a pattern of len durations in a row.
+   * @return index of the trigger or -1 when no more triggers are available.
+   */
+  int addTrigger(const SignalParser::CodeTime *minTime, const SignalParser::CodeTime *maxTime, int len);
+
+  /** Add a capture trigger matching the start code of a loaded protocol.
+   * @return index of the trigger or -1 when no more triggers are available.
+   */
+  int addTrigger(const char *protocolName);
+
+  // Remove all capture triggers.
+  void clearTriggers();
+
+  /**
+   * @brief Start capturing all received timings into the buffer in addition to parsing them.
+   * When a trigger matches, the timings before and including the trigger
+   * and len - preTrigger timings after the trigger are kept.
+   * @param buffer The buffer for the captured timings.
+   * @param len The length of the buffer.
+   * @param preTrigger The number of timings kept before and including the trigger.
+   * @return true when capturing was started.
+   */
+  bool startCapture(SignalParser::CodeTime *buffer, int len, int preTrigger);
+
+  // Stop capturing.
+  void stopCapture();
+
+  // Return the state of the capture mode SC_CAPTURE_*.
+  int getCaptureState()
+  {
+    return (_captureState);
+  };
+
+  // Return the index of the trigger that started the recording or -1.
+  int getCaptureTrigger()
+  {
+    return (_captureTrigger);
+  };
+
+  /** Return the captured timings without copying when the capture is done.
+   * The timings can be exported in small parts from loop() until the next startCapture().
+   * @param span target for the timings.
+   * @return the index of the trigger timing in the span or -1 when the capture is not done.
+   */
+  int getCapture(TimingSpan *span);
+
   // ===== Insights and Debugging Helpers =====
 
   // Return the number of buffered data in the ring buffer.
@@ -55,7 +208,22 @@ public:
   // called more often.
   uint32_t getBufferCount()
   {
-    return (buf88_cnt);
+    SignalParser::CodeTime *w = ringWrite.load(std::memory_order_acquire);
+    SignalParser::CodeTime *r = buf88_read.load(std::memory_order_acquire);
+    return ((w >= r) ? (w - r) : (SC_BUFFERSIZE + w - r));
+  };
+
+  // Return the maximal time in µsecs between the last signal change and finishing the sequences
+  // by the idle timeout.
+  unsigned long getMaxIdleLatency()
+  {
+    return (_maxIdleLatency);
+  };
+
+  // Return the number of timings that have been dropped because the ring buffer was full.
+  unsigned long getDroppedCount()
+  {
+    return (buf88_dropped);
   };
 
   /** Return the last received timings from the ring-buffer.
@@ -66,36 +234,131 @@ public:
    */
   void getBufferData(SignalParser::CodeTime *buffer, int len);
 
+  /** Keep the timings of the sequences not finished yet in the ring buffer for getFrameTimings().
+   * Up to SC_KEEPSIZE timings are then not available for receiving, so this is off by default.
+   * @param enable true to keep the timings.
+   */
+  void keepTimings(bool enable = true)
+  {
+    _keepTimings = enable;
+  };
+
+  /** Return the timings of the code sequence passed to the callback function without copying.
+   * The timings stay in the ring buffer until the callback function returns.
+   * This is only available after keepTimings() and not for sequences passed by a queue or in pipelined mode.
+   * @param span target for the timings
+   * @return true when the timings are available.
+   */
+  bool getFrameTimings(TimingSpan *span);
+
   /** dump the data from a table of timings that end with a 0 time.
    * @param raw pointer to raw timings data.
   */
   void dumpTimings(SignalParser::CodeTime *raw);
 
+  /** dump the timings of a sequence.
+   * @param span timings returned by getFrameTimings().
+  */
+  void dumpTimings(const TimingSpan *span);
+
   // Inject a test timing into the ring buffer.
-  void injectTiming(SignalParser::CodeTime t);
+  // Durations longer than SP_MAXTIME are saturated.
+  void injectTiming(unsigned long t);
 
 
 private:
   // Ring buffer
   // A simple ring buffer is used to decouple interrupt routine.
   // Static variables are used to be known in the ISR
+  // The write pointer is only changed by the ISR, the read pointer only by the parser
+  // so the parser may run in another task. One entry is kept free to detect a full buffer.
+  // The timings of sequences not finished yet are kept before the read pointer
+  // so they can be passed to the callback function without copying.
   static SignalParser::CodeTime *buf88; // allocated memory
-  static volatile SignalParser::CodeTime *ringWrite; // write pointer
-  static volatile SignalParser::CodeTime *buf88_read; // read pointer
+  static std::atomic<SignalParser::CodeTime *> ringWrite; // write pointer
+  static std::atomic<SignalParser::CodeTime *> buf88_read; // read pointer
+  static std::atomic<SignalParser::CodeTime *> ringKeep; // oldest timing that is kept
   static SignalParser::CodeTime *buf88_end; // end of buffer+1 pointer for wrapping
-  static volatile unsigned int buf88_cnt; // number of bytes in buffer
+  static volatile unsigned long buf88_dropped; // number of dropped timings
 
-  static unsigned long lastTime; // last time the interrupt was called.
+  static volatile unsigned long lastTime; // last time the interrupt was called.
 
   SignalParser *_sig;
 
+  /** receive backend */
+  SignalReceiver *_receiver = nullptr;
+  bool _blockParse = false; // is true while parsing a block from the backend.
+
+  // parse all timings from the ring buffer.
+  void _parseBuffer();
+
+  // pass the codes queued by the parser before the queue overflows.
+  void _dispatchFull();
+
+  // release the parsed timings that are not part of a sequence any more.
+  void _releaseTimings();
+  unsigned long _keepPosition = 0; // parser position of the oldest timing that is kept.
+  bool _keepTimings = false; // keep the timings for getFrameTimings().
+
+  /** idle timeout */
+  unsigned long _idleTimeout = 0;
+  unsigned long _idleTime = 0; // time of the signal change that was followed by the last timeout.
+  unsigned long _maxIdleLatency = 0;
+
+  // finish the sequences when the idle timeout is reached.
+  void _checkIdle();
+
+  /** capture mode, static to be known in the ISR */
+  struct Trigger {
+    SignalParser::CodeTime minTime[SC_TRIGGERLEN];
+    SignalParser::CodeTime maxTime[SC_TRIGGERLEN];
+    int length;
+    uint32_t matched; // bit k is set when the last k+1 durations match the first k+1 windows.
+  };
+
+  static Trigger _triggers[SC_TRIGGERS];
+  static int _triggerCount;
+
+  static SignalParser::CodeTime *_captureBuffer;
+  static int _captureSize; // length of the buffer
+  static int _capturePre; // number of timings before and including the trigger
+  static volatile int _capturePos; // next position in the buffer
+  static volatile int _captureCount; // number of captured timings up to the buffer length
+  static volatile int _capturePost; // number of timings to capture after the trigger
+  static volatile int _captureState;
+  static volatile int _captureTrigger;
+
+  // capture a timing and check the triggers.
+  static void IRAM_ATTR _captureTiming(SignalParser::CodeTime t);
+
+  /** pipelined mode */
+  std::atomic<bool> _pipelineActive{false};
+  std::atomic<void *> _pipelineHandle{nullptr}; // task or thread parsing the timings, cleared by the ESP32 task when it ends.
+  SignalQueue *_parserQueue = nullptr; // queue of the parser before the pipelined mode.
+
+  static void _pipelineTask(void *arg);
+
 
   /** hardware related settings */
   static int _recvPin; // IO Pin number for receiving signals. static, to be
       // known in the ISR
   int _sendPin; // IO Pin number for sendint signals.
+  unsigned int _carrier = 0; // carrier frequency while sending.
+  unsigned int _carrierDuty = 0; // carrier duty in 1/255.
+
+  SignalParser::CodeTime *_sendRecord = nullptr; // buffer to record the send envelope.
+  int _sendRecordLen = 0;
+  SignalParser::CodeTime *_sendRecordEnd = nullptr; // last position in the buffer while sending.
+  unsigned long _sendRecordTime = 0; // time of the last change of the output.
+  bool _sendRecordStarted = false; // true after the first mark.
+
+  // start and stop the carrier modulation when supported by the hardware.
+  void _carrierBegin(unsigned int frequency, unsigned int dutyCycle);
+  void _carrierEnd();
+
+  // set the output level or switch the carrier and record the duration since the last change.
+  void _sendLevel(int level);
   int _irNumber; // Interrupt number of receiver.
-  static int _trim; // timming factor
 
 
   // ===== Interrupt service routine =====
@@ -0,0 +1,138 @@
+/**
+ * @file SignalFingerprint.cpp
+ *
+ * This file is part of the RFCodes library that implements receiving an sending
+ * RF and IR protocols.
+ *
+ * @copyright Copyright (c) by Matthias Hertel, https://www.mathertel.de.
+ *
+ * This work is licensed under a BSD 3-Clause style license,
+ * https://www.mathertel.de/License.aspx.
+ *
+ * @brief
+ * Fingerprints of unknown signals that are not decoded by any loaded protocol.
+ *
+ * Change History see SignalFingerprint.h
+ */
+
+#include <Arduino.h>
+
+#include "SignalFingerprint.h"
+
+typedef SignalParser::CodeTime CodeTime;
+
+
+/** Add a duration. */
+bool SignalFingerprint::add(CodeTime duration) {
+  _durations += duration;
+
+  if (duration >= _gapTime) {
+    return (_finish());
+  }
+
+  if (_valid) {
+    if ((duration < SF_MINTIME) || (_len >= SF_MAXLEN)) {
+      // noise or not a burst of a remote control, wait for the next gap.
+      _valid = false;
+
+    } else {
+      _burst[_len++] = duration;
+      if (duration < _min) {
+        _min = duration;
+      }
+    }
+  }  // if
+  return (false);
+}  // add()
+
+
+/** Finish the current burst. */
+bool SignalFingerprint::flush() {
+  return (_finish());
+}  // flush()
+
+
+/** fingerprint the current burst and start a new one. */
+bool SignalFingerprint::_finish() {
+  bool found = false;
+
+  // a replayed capture passes no real time, a silence is only one saturated duration.
+  unsigned long now = micros();
+  unsigned long passed = now - _lastMicros;
+  if (passed < _durations) {
+    passed = _durations;
+  }
+  _time += passed;
+  _lastMicros = now;
+  _durations = 0;
+
+  if (_valid && !_known && (_len >= SF_MINLEN)) {
+    _burstCount++;
+
+    // the base time is the average of the durations near the shortest one.
+    unsigned long limit = _min + (_min * 3) / 4;
+    unsigned long sum = 0;
+    int cnt = 0;
+    for (int n = 0; n < _len; n++) {
+      if (_burst[n] <= limit) {
+        sum += _burst[n];
+        cnt++;
+      }
+    }  // for
+    CodeTime base = sum / cnt;
+
+    // FNV-1a hash of the quantized durations.
+    uint32_t hash = 2166136261UL;
+    for (int n = 0; n < _len; n++) {
+      unsigned long q = (_burst[n] + base / 2) / base;
+      if (q > SF_MAXFACTOR) {
+        q = SF_MAXFACTOR;
+      }
+      hash = (hash ^ q) * 16777619UL;
+    }  // for
+
+    // find the fingerprint or replace the oldest one.
+    Slot *s = nullptr;
+    Slot *oldest = &_slots[0];
+    for (int n = 0; n < SF_SLOTS; n++) {
+      Slot *t = &_slots[n];
+      if ((t->count) && (t->hash == hash) && (t->length == _len)) {
+        s = t;
+      }
+      if ((_time - t->last) > (_time - oldest->last)) {
+        oldest = t;
+      }
+    }  // for
+
+    if (s && ((_time - s->last) > SF_HOLDTIME)) {
+      // not a repeat but the next use of the same button.
+      s->count = 0;
+    } else if (!s) {
+      s = oldest;
+      s->hash = hash;
+      s->length = _len;
+      s->count = 0;
+    }
+    s->count++;
+    s->last = _time;
+
+    if (s->count == SF_REPEATS) {
+      TRACE_MSG("fingerprint %08lx %d %u", (unsigned long)hash, _len, base);
+      _hash = hash;
+      _length = _len;
+      _base = base;
+      snprintf(_code, SF_CODELEN, "%08lx %d %u", (unsigned long)hash, _len, base);
+      _reportCount++;
+      found = true;
+    }
+  }  // if
+
+  // start a new burst
+  _len = 0;
+  _min = SP_MAXTIME;
+  _valid = true;
+  _known = false;
+  return (found);
+}  // _finish()
+
+// End.
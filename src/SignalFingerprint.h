@@ -0,0 +1,148 @@
+/**
+ * @file: SignalFingerprint.h
+ *
+ * This file is part of the RFCodes library that implements receiving an sending
+ * RF and IR protocols.
+ *
+ * @copyright Copyright (c) by Matthias Hertel, https://www.mathertel.de.
+ *
+ * This work is licensed under a BSD 3-Clause style license,
+ * https://www.mathertel.de/License.aspx.
+ *
+ * @brief
+ * Fingerprints of unknown signals that are not decoded by any loaded protocol.
+ *
+ * The durations are split into bursts at long gaps. At the end of a burst the base time is
+ * estimated from the shortest durations and all durations are quantized as factors of the base time.
+ * The hash of the factors, the number of durations and the base time form the fingerprint.
+ * When the same fingerprint is seen SF_REPEATS times, e.g. by the repeats of a remote control,
+ * it is reported using the code "fp <hash> <length> <base>".
+ *
+ * The memory is fixed and every duration is stored once and processed once more at the end of the burst.
+ *
+ * Changelog:
+ * * 18.10.2026 created by agent
+ * * 18.10.2026 the hold time includes silences longer than a duration.
+ */
+
+#ifndef SignalFingerprint_H_
+#define SignalFingerprint_H_
+
+#include "SignalParser.h"
+
+#define SF_NAME "fp"  // protocol name used to report fingerprints
+
+#define SF_MAXLEN 200     // maximal number of durations in a burst
+#define SF_MINLEN 16      // minimal number of durations in a burst
+#define SF_MINTIME 100    // shorter durations are noise and drop the burst
+#define SF_MAXFACTOR 63   // longer durations are quantized to this factor of the base time
+#define SF_SLOTS 8        // number of recently seen fingerprints
+#define SF_REPEATS 2      // a fingerprint is reported when seen this number of times
+#define SF_HOLDTIME 1000000UL  // time in µsecs a fingerprint is remembered without repeat
+
+#define SF_CODELEN 32  // length of the code text "<hash> <length> <base>"
+
+class SignalFingerprint {
+public:
+  /**
+   * @param gapTime Durations of at least this time in µsecs split the bursts.
+   */
+  SignalFingerprint(SignalParser::CodeTime gapTime = 5000)
+    : _gapTime(gapTime){};
+
+  /** Add a duration.
+   * @return true when a repeated unknown burst was finished by this duration, see getCode().
+   */
+  bool add(SignalParser::CodeTime duration);
+
+  /** Finish the current burst, e.g. after a timeout.
+   * @return true when a repeated unknown burst was finished, see getCode().
+   */
+  bool flush();
+
+  /** Mark the current burst as decoded by a protocol so it is not fingerprinted. */
+  void known() {
+    _known = true;
+  };
+
+  /** Return the number of durations in the current burst. */
+  int getBurstLength() {
+    return (_valid ? _len : 0);
+  };
+
+  /** Return the text "<hash> <length> <base>" of the reported fingerprint. */
+  const char *getCode() {
+    return (_code);
+  };
+
+  /** Return the hash of the reported fingerprint. */
+  uint32_t getHash() {
+    return (_hash);
+  };
+
+  /** Return the number of durations of the reported fingerprint. */
+  int getLength() {
+    return (_length);
+  };
+
+  /** Return the base time of the reported fingerprint. */
+  SignalParser::CodeTime getBase() {
+    return (_base);
+  };
+
+  // ===== Insights and Debugging Helpers =====
+
+  // Return the number of bursts that have been fingerprinted.
+  unsigned long getBurstCount() {
+    return (_burstCount);
+  };
+
+  // Return the number of reported fingerprints.
+  unsigned long getReportCount() {
+    return (_reportCount);
+  };
+
+private:
+  // a recently seen fingerprint.
+  struct Slot {
+    uint32_t hash;
+    uint16_t length;
+    uint16_t count;      // number of times seen
+    unsigned long last;  // time when last seen
+  };
+
+  SignalParser::CodeTime _gapTime;
+
+  // the current burst
+  SignalParser::CodeTime _burst[SF_MAXLEN];
+  int _len = 0;
+  SignalParser::CodeTime _min = SP_MAXTIME;  // shortest duration
+  bool _valid = true;   // false after noise or too many durations until the next gap.
+  bool _known = false;  // true when decoded by a protocol.
+
+  // sum of the durations since the end of the last burst in µsecs.
+  unsigned long _durations = 0;
+
+  // micros() at the end of the last burst.
+  unsigned long _lastMicros = 0;
+
+  // time at the end of the last burst in µsecs.
+  // Long silences are saturated durations, so it advances by micros() when that passed more time.
+  unsigned long _time = 0;
+
+  Slot _slots[SF_SLOTS] = {};
+
+  // the reported fingerprint
+  uint32_t _hash = 0;
+  int _length = 0;
+  SignalParser::CodeTime _base = 0;
+  char _code[SF_CODELEN] = "";
+
+  unsigned long _burstCount = 0;
+  unsigned long _reportCount = 0;
+
+  /** fingerprint the current burst and start a new one. */
+  bool _finish();
+};  // class SignalFingerprint
+
+#endif  // SignalFingerprint_H_
@@ -0,0 +1,233 @@
+/**
+ * @file SignalOutput.cpp
+ *
+ * This file is part of the RFCodes library that implements receiving an sending
+ * RF and IR protocols.
+ *
+ * @copyright Copyright (c) by Matthias Hertel, https://www.mathertel.de.
+ *
+ * This work is licensed under a BSD 3-Clause style license,
+ * https://www.mathertel.de/License.aspx.
+ *
+ * @brief
+ * A buffered output of decoded code sequences and timings that never blocks the receiving.
+ *
+ * Change History see SignalOutput.h
+ */
+
+#include <Arduino.h>
+
+#include "SignalOutput.h"
+
+#if !defined(ARDUINO)
+// host environment
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+// ===== private functions =====
+
+
+/** start a new record. */
+void SignalOutput::_start() {
+  unsigned int head = _head.load(std::memory_order_relaxed);
+  _write = head;
+  _free = SO_BUFFERSIZE - (head - _tail.load(std::memory_order_acquire));
+  _overflow = false;
+}  // _start()
+
+
+/** add a decimal number to the record. */
+void SignalOutput::_putNumber(unsigned int v) {
+  char digits[12];
+  int n = 0;
+  do {
+    digits[n++] = '0' + (v % 10);
+    v /= 10;
+  } while (v);
+
+  while (n) {
+    _put(digits[--n]);
+  }
+}  // _putNumber()
+
+
+/** add the header of a binary record. */
+void SignalOutput::_putHeader(char type, unsigned int len) {
+  _put(type);
+  _put16(len);
+}  // _putHeader()
+
+
+/** add the timings of a record. */
+void SignalOutput::_putTimings(const SignalParser::CodeTime *timings, int count, bool first) {
+  for (int n = 0; (n < count) && (!_overflow); n++) {
+    if (_format == SO_FORMAT_BINARY) {
+      _put16(timings[n]);
+    } else {
+      if (!first) {
+        _put(',');
+      }
+      _putNumber(timings[n]);
+      first = false;
+    }
+  }  // for
+}  // _putTimings()
+
+
+/** finish the record or drop it when it did not fit into the buffer. */
+bool SignalOutput::_commit() {
+  if (_overflow) {
+    _dropped = _dropped + 1;
+    return (false);
+  }
+
+  _head.store(_write, std::memory_order_release);
+  unsigned int used = _write - _tail.load(std::memory_order_acquire);
+  if (used > _maxUsed) {
+    _maxUsed = used;
+  }
+  return (true);
+}  // _commit()
+
+
+/** write bytes to the target without blocking. */
+int SignalOutput::_writeTarget(const char *data, int len) {
+  int cnt = 0;
+
+  if (_stream) {
+    int space = _stream->availableForWrite();
+    if (space > 0) {
+      _streamSpace = true;
+    } else if (!_streamSpace) {
+      // availableForWrite() is not implemented by the Stream.
+      space = SO_BLOCKWRITE;
+    }
+    if (len > space) {
+      len = space;
+    }
+    if (len > 0) {
+      cnt = _stream->write((const uint8_t *)data, len);
+    }
+
+#if !defined(ARDUINO)
+  } else if (_fd >= 0) {
+    cnt = ::write(_fd, data, len);
+    if (cnt < 0) {
+      // EAGAIN: the pipe is full, try again later.
+      cnt = 0;
+    }
+#endif
+  }
+  return (cnt);
+}  // _writeTarget()
+
+
+// ===== public functions =====
+
+
+/** Write the records to a Stream. */
+void SignalOutput::begin(Stream *stream, int format) {
+  _stream = stream;
+  _streamSpace = false;
+  _fd = -1;
+  _format = format;
+}  // begin()
+
+
+#if !defined(ARDUINO)
+/** Write the records to a file or pipe on a host. */
+void SignalOutput::begin(int fd, int format) {
+  struct stat st;
+  if ((fstat(fd, &st) == 0) && (S_ISFIFO(st.st_mode) || S_ISSOCK(st.st_mode))) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  }
+  _stream = nullptr;
+  _fd = fd;
+  _format = format;
+}  // begin()
+#endif
+
+
+/** Add a decoded sequence. */
+bool SignalOutput::writeFrame(const char *code, int device) {
+  _start();
+
+  if (_format == SO_FORMAT_BINARY) {
+    _putHeader(SO_RECORD_FRAME, 2 + strlen(code));
+    _put16((uint16_t)device);
+    while (*code) {
+      _put(*code++);
+    }
+
+  } else {
+    while (*code) {
+      _put(*code++);
+    }
+    if (device >= 0) {
+      _put(' ');
+      _put('@');
+      _putNumber(device);
+    }
+    _put('\n');
+  }
+  return (_commit());
+}  // writeFrame()
+
+
+/** Add timings. */
+bool SignalOutput::writeTimings(const SignalParser::CodeTime *timings, int count) {
+  SignalCollector::TimingSpan span = { timings, count, nullptr, 0 };
+  return (writeTimings(&span));
+}  // writeTimings()
+
+
+/** Add the timings of a span. */
+bool SignalOutput::writeTimings(const SignalCollector::TimingSpan *span) {
+  _start();
+
+  if (_format == SO_FORMAT_BINARY) {
+    _putHeader(SO_RECORD_TIMINGS, 2 * (span->firstLength + span->secondLength));
+  } else {
+    _put(SO_RECORD_TIMINGS);
+    _put(' ');
+  }
+  _putTimings(span->first, span->firstLength, true);
+  _putTimings(span->second, span->secondLength, (span->firstLength == 0));
+
+  if (_format != SO_FORMAT_BINARY) {
+    _put('\n');
+  }
+  return (_commit());
+}  // writeTimings()
+
+
+/** Pass buffered records to the target as far as possible without blocking. */
+int SignalOutput::loop() {
+  int cnt = 0;
+
+  // the buffered bytes may wrap at the end of the buffer.
+  for (int part = 0; part < 2; part++) {
+    unsigned int tail = _tail.load(std::memory_order_relaxed);
+    unsigned int used = _head.load(std::memory_order_acquire) - tail;
+    unsigned int pos = tail & (SO_BUFFERSIZE - 1);
+    int len = (used < SO_BUFFERSIZE - pos) ? used : SO_BUFFERSIZE - pos;
+
+    if (len == 0) {
+      break;
+    }
+
+    int written = _writeTarget(_buffer + pos, len);
+    _tail.store(tail + written, std::memory_order_release);
+    cnt += written;
+    if (written < len) {
+      break;  // the target is full
+    }
+  }  // for
+  return (cnt);
+}  // loop()
+
+// End.
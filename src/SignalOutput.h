@@ -0,0 +1,168 @@
+/**
+ * @file: SignalOutput.h
+ *
+ * This file is part of the RFCodes library that implements receiving an sending
+ * RF and IR protocols.
+ *
+ * @copyright Copyright (c) by Matthias Hertel, https://www.mathertel.de.
+ *
+ * This work is licensed under a BSD 3-Clause style license,
+ * https://www.mathertel.de/License.aspx.
+ *
+ * @brief
+ * A buffered output of decoded code sequences and timings that never blocks the receiving.
+ * The records are written into a buffer with a fixed size and passed to a Stream
+ * (or a file or pipe on a host) by loop() only as far as the Stream can take them without waiting.
+ * Records that don't fit into the buffer are dropped and counted, see getDropped().
+ *
+ * The free space of a Stream is taken from availableForWrite().
+ * Streams that don't implement it always report 0, they are written with blocking
+ * with up to SO_BLOCKWRITE bytes per loop() until they report free space once.
+ *
+ * The buffer is lock-free for exactly one producer (e.g. the callback function) and one
+ * consumer (loop()) and can be used between threads or cores.
+ *
+ * Text format: one line per record.
+ * * "<protocolname> <sequence>" or "<protocolname> <sequence> @<device>"
+ * * "T <timing>,<timing>,..."
+ *
+ * Binary format: records with a type byte and the length of the following data
+ * as 16 bit little endian value.
+ * * 'F' device as 16 bit little endian value followed by "<protocolname> <sequence>"
+ * * 'T' timings as 16 bit little endian values
+ *
+ * Changelog:
+ * * 18.10.2026 created by agent
+ * * 18.10.2026 bounded blocking writes to a Stream without availableForWrite().
+ */
+
+#ifndef SignalOutput_H_
+#define SignalOutput_H_
+
+#include <Arduino.h>
+#include <atomic>
+
+#include "SignalCollector.h"
+
+#define SO_BUFFERSIZE 2048  // size of the output buffer in bytes, must be a power of 2
+#define SO_BLOCKWRITE 64    // bytes written per loop() to a Stream that never reported free space
+
+#define SO_FORMAT_TEXT 0    // one text line per record
+#define SO_FORMAT_BINARY 1  // binary records with type and length
+
+#define SO_RECORD_FRAME 'F'    // record type of a code sequence
+#define SO_RECORD_TIMINGS 'T'  // record type of timings
+
+class SignalOutput {
+public:
+  /** Write the records to a Stream, e.g. Serial.
+   * @param stream The target of the records.
+   * @param format SO_FORMAT_TEXT or SO_FORMAT_BINARY.
+   */
+  void begin(Stream *stream, int format = SO_FORMAT_TEXT);
+
+#if !defined(ARDUINO)
+  /** Write the records to a file or pipe on a host.
+   * Pipes are switched to non-blocking mode.
+   * @param fd The file descriptor of the target.
+   * @param format SO_FORMAT_TEXT or SO_FORMAT_BINARY.
+   */
+  void begin(int fd, int format = SO_FORMAT_TEXT);
+#endif
+
+  /** Add a decoded sequence, e.g. in the callback function.
+   * @param code The code in the format "<protocolname> <sequence>".
+   * @param device The device id of a subscription or -1.
+   * @return false when the buffer is full and the record was dropped.
+   */
+  bool writeFrame(const char *code, int device = -1);
+
+  /** Add timings, e.g. the timings of a received sequence.
+   * @return false when the buffer is full and the record was dropped.
+   */
+  bool writeTimings(const SignalParser::CodeTime *timings, int count);
+
+  /** Add the timings of a span, e.g. from SignalCollector::getFrameTimings().
+   * @return false when the buffer is full and the record was dropped.
+   */
+  bool writeTimings(const SignalCollector::TimingSpan *span);
+
+  /** Pass buffered records to the target as far as possible without blocking.
+   * This function must be called from the main loop function.
+   * @return number of bytes written.
+   */
+  int loop();
+
+  // ===== Insights and Debugging Helpers =====
+
+  // Return the number of bytes in the buffer.
+  unsigned int getUsed() {
+    return (_head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire));
+  };
+
+  // Return the maximum number of bytes in the buffer that have been seen.
+  unsigned int getMaxUsed() {
+    return (_maxUsed);
+  };
+
+  // Return the number of records that have been dropped because the buffer was full.
+  unsigned long getDropped() {
+    return (_dropped);
+  };
+
+private:
+  Stream *_stream = nullptr;
+  bool _streamSpace = false;  // true when availableForWrite() of the Stream reported free space.
+  int _fd = -1;
+  int _format = SO_FORMAT_TEXT;
+
+  char _buffer[SO_BUFFERSIZE];
+
+  // free running indexes, only written by the producer (_head) or the consumer (_tail).
+  std::atomic<unsigned int> _head{0};
+  std::atomic<unsigned int> _tail{0};
+
+  // the record being written, only used by the producer.
+  unsigned int _write = 0;
+  unsigned int _free = 0;
+  bool _overflow = false;
+
+  // statistics, only written by the producer.
+  volatile unsigned int _maxUsed = 0;
+  volatile unsigned long _dropped = 0;
+
+  /** start a new record. */
+  void _start();
+
+  /** add a byte to the record. */
+  void _put(uint8_t b) {
+    if ((_write - _head.load(std::memory_order_relaxed)) < _free) {
+      _buffer[_write++ & (SO_BUFFERSIZE - 1)] = b;
+    } else {
+      _overflow = true;
+    }
+  };
+
+  /** add a 16 bit little endian value to the record. */
+  void _put16(uint16_t v) {
+    _put(v & 0xFF);
+    _put(v >> 8);
+  };
+
+  /** add a decimal number to the record. */
+  void _putNumber(unsigned int v);
+
+  /** add the header of a binary record. */
+  void _putHeader(char type, unsigned int len);
+
+  /** add the timings of a record. */
+  void _putTimings(const SignalParser::CodeTime *timings, int count, bool first);
+
+  /** finish the record or drop it when it did not fit into the buffer. */
+  bool _commit();
+
+  /** write bytes to the target without blocking. */
+  int _writeTarget(const char *data, int len);
+};  // class SignalOutput
+
+#endif  // SignalOutput_H_
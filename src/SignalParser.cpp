@@ -19,27 +19,27 @@
 #include <Arduino.h>
 
 #include "SignalParser.h"
+#include "SignalQueue.h"
+#include "SignalClassifier.h"
+#include "SignalFingerprint.h"
 
 
 // ===== private functions =====
 
 
-/** find protocol by name */
-SignalParser::Protocol *SignalParser::_findProt(char *name) {
-  Protocol *p = nullptr;
-
-  for (int n = 0; n < _protocolCount; n++) {
-    p = _protocol[n];
-    if (strcmp(name, p->name) == 0)
-      break;
+/** find protocol by name, returns the number of the protocol or -1. */
+int SignalParser::_findProt(const char *name) {
+  for (int n = 0; n < _getProtCount(); n++) {
+    if (strcmp(name, _getProt(n)->name) == 0)
+      return (n);
   }
-  return (p);
+  return (-1);
 }  // _findProt()
 
 
 /** find code by name */
-SignalParser::Code *SignalParser::_findCode(Protocol *p, char codeName) {
-  Code *c = p->codes;
+const SignalParser::Code *SignalParser::_findCode(const Protocol *p, char codeName) {
+  const Code *c = p->codes;
   int cnt = p->codeLength;
 
   while (c && cnt) {
@@ -53,72 +53,306 @@ SignalParser::Code *SignalParser::_findCode(Protocol *p, char codeName) {
 
 
 /** reset all codes in a protocol */
-void SignalParser::_resetCodes(Protocol *p) {
-  Code *c = p->codes;
+void SignalParser::_resetCodes(const Protocol *p, ProtState *s) {
+  CodeState *cs = s->codes;
   int cCnt = p->codeLength;
-  while (c && cCnt) {
-    c->valid = true;
-    c->cnt = 0;
-    c->total = 0;
-
-    c++;
+  while (cCnt) {
+    cs->valid = true;
+    cs->cnt = 0;
+    cs->total = 0;
+    cs->trimSum = 0;
+    cs->trimCnt = 0;
+
+    cs++;
     cCnt--;
   }
 }  // _resetCodes()
 
 
 /** reset the whole protocol to start capturing from scratch. */
-void SignalParser::_resetProtocol(Protocol *p) {
+void SignalParser::_resetProtocol(const Protocol *p, ProtState *s) {
   TRACE_MSG("  reset prot: %s", p->name);
-  p->seqLen = 0;
-  p->seq[0] = NUL;
-  _resetCodes(p);
-  _recalcProtocol(p, p->baseTime);
+  // windows have been adjusted when a sequence was started.
+  bool adjusted = (s->seqLen > 0) || (s->realBase != p->baseTime);
+
+  s->seqLen = 0;
+  s->seq[0] = NUL;
+  s->active = false;
+  s->check = 0;
+  s->subNode = s->subRoot;
+  s->device = -1;
+  _resetCodes(p, s);
+  if (adjusted) {
+    // use the windows of the protocol again.
+    for (int cl = 0; cl < p->codeLength; cl++) {
+      memcpy(s->codes[cl].minTime, p->codes[cl].minTime, sizeof(p->codes[cl].minTime));
+      memcpy(s->codes[cl].maxTime, p->codes[cl].maxTime, sizeof(p->codes[cl].maxTime));
+    }
+    s->realBase = p->baseTime;
+  }
 }  // _resetProtocol()
 
 
-/** use the callback function when registered using format <protocolname> <sequence> */
-void SignalParser::_useCallback(Protocol *p) {
-  if (p && _callbackFunc) {
-    String code;
-    code += p->name;
-    code += ' ';
-    code += p->seq;
-    _callbackFunc(code.c_str());
+/** initialize the parsing state of a protocol. */
+void SignalParser::_initState(const Protocol *p, ProtState *s) {
+  memset(s, 0, sizeof(ProtState));
+  s->trim = _trim;
+  s->trimTrack = (long)_trim * (1 << SP_BASE_FRACT);
+  _resetProtocol(p, s);  // copies the windows as realBase is 0.
+  _calcStartFilter(p, s);
+}  // _initState()
+
+
+/** adjust the base time by the timings of a completely received code. */
+void SignalParser::_trackBase(const Protocol *p, ProtState *s, const Code *c, CodeState *cs) {
+  unsigned long measured = ((unsigned long)cs->total << SP_BASE_FRACT) / c->timeSum;
+
+  if (s->seqLen == 0) {
+    // the start code gives the first estimation.
+    s->baseTrack = measured;
+  } else {
+    // follow slowly to not be disturbed by the jitter of a single code.
+    s->baseTrack = s->baseTrack + ((long)(measured - s->baseTrack) / SP_BASE_GAIN);
+  }
+
+  CodeTime base = (s->baseTrack + (1 << (SP_BASE_FRACT - 1))) >> SP_BASE_FRACT;
+  if ((s->seqLen == 0) || (base != s->realBase)) {
+    _recalcState(p, s, base);
+  }
+}  // _trackBase()
+
+
+/** adjust the trim by the deviations of the marks and spaces of an accepted sequence. */
+void SignalParser::_learnTrim(const Protocol *p, ProtState *s) {
+  if (_trimLearn && (s->trimCnt > 0)) {
+    // the deviations are measured after correcting by the current trim.
+    long measured = (s->trimSum * (1 << SP_BASE_FRACT)) / s->trimCnt;
+    s->trimTrack = s->trimTrack + (measured / SP_TRIM_GAIN);
+
+    // never correct more than half of the base time.
+    long limit = (long)p->baseTime << (SP_BASE_FRACT - 1);
+    if (s->trimTrack > limit) {
+      s->trimTrack = limit;
+    } else if (s->trimTrack < -limit) {
+      s->trimTrack = -limit;
+    }
+
+    long half = (1 << (SP_BASE_FRACT - 1));
+    int trim = (s->trimTrack + (s->trimTrack < 0 ? -half : half)) / (1 << SP_BASE_FRACT);
+    if (trim != s->trim) {
+      TRACE_MSG("trim %s %d", p->name, trim);
+      s->trim = trim;
+      _calcStartFilter(p, s);
+    }
+  }
+}  // _learnTrim()
+
+
+/** calculate the start prefilter from the first timing of all start codes including the trim. */
+void SignalParser::_calcStartFilter(const Protocol *p, ProtState *s) {
+  // the windows of the protocol span all base times.
+  long filterMin = SP_MAXTIME;
+  long filterMax = 0;
+  for (int cl = 0; cl < p->codeLength; cl++) {
+    const Code *c = &(p->codes[cl]);
+    if ((c->type & START) && (c->timeLength > 0)) {
+      if (c->minTime[0] < filterMin)
+        filterMin = c->minTime[0];
+      if (c->maxTime[0] > filterMax)
+        filterMax = c->maxTime[0];
+    }
+  }  // for
+
+  // the first timing is a mark that is received longer by the trim.
+  if (filterMin <= filterMax) {
+    filterMin += s->trim;
+    filterMax += s->trim;
+  }
+  s->filterMin = (filterMin < 0) ? 0 : toCodeTime(filterMin);
+  s->filterMax = (filterMax < 0) ? 0 : toCodeTime(filterMax);
+  _filterChanged = true;
+}  // _calcStartFilter()
+
+
+/** add a new node to the subscription trie, returns 0 when full. */
+uint16_t SignalParser::_subNew(char name) {
+  if (_subCount == 0) {
+    _subCount = 1;  // node 0 is not used.
+  }
+  if (_subCount >= 0xFFFF) {
+    return (0);
+  }
+
+  if (_subCount >= _subAlloc) {
+    _subAlloc += 32;
+    TRACE_MSG("alloc subscriptions %d", _subAlloc);
+    _subNodes = (SubNode *)realloc(_subNodes, _subAlloc * sizeof(SubNode));
   }
+
+  SubNode *s = &_subNodes[_subCount];
+  s->name = name;
+  s->child = 0;
+  s->next = 0;
+  s->device = -1;
+  return (_subCount++);
+}  // _subNew()
+
+
+/** return the child node of n with the code name or create a new one. */
+uint16_t SignalParser::_subChild(uint16_t n, char name) {
+  uint16_t c = _subNodes[n].child;
+  while (c && (_subNodes[c].name != name)) {
+    c = _subNodes[c].next;
+  }
+
+  if (!c) {
+    c = _subNew(name);
+    if (c) {
+      _subNodes[c].next = _subNodes[n].child;
+      _subNodes[n].child = c;
+    }
+  }
+  return (c);
+}  // _subChild()
+
+
+/** check the last added code using the pattern, subscriptions and validate function. */
+bool SignalParser::_validateCode(const Protocol *p, ProtState *s) {
+  int pos = s->seqLen - 1;
+
+  if ((pos < p->patternLen) && (p->pattern[pos] != '?') && (p->pattern[pos] != s->seq[pos])) {
+    return (false);
+  }
+
+  if (s->subNode) {
+    // walk the subscription trie
+    uint16_t n = _subNodes[s->subNode].child;
+    while (n && (_subNodes[n].name != s->seq[pos])) {
+      n = _subNodes[n].next;
+    }
+
+    if (n) {
+      if (_subNodes[n].device >= 0) {
+        s->device = _subNodes[n].device;
+      }
+      s->subNode = (_subNodes[n].child ? n : 0);
+
+    } else if (s->device >= 0) {
+      // a shorter subscription matches, no need to walk further.
+      s->subNode = 0;
+
+    } else {
+      return (false);
+    }
+  }  // if
+
+  if ((p->validate) && (!p->validate(s->seq, s->seqLen, &s->check, false))) {
+    return (false);
+  }
+  return (true);
+}  // _validateCode()
+
+
+/** use the callback function or queue when registered using format <protocolname> <sequence> */
+void SignalParser::_useCallback(const Protocol *p, ProtState *s) {
+  if (p->validate && !p->validate(s->seq, s->seqLen, &s->check, true)) {
+    TRACE_MSG("  invalid: %s", s->seq);
+    s->rejectCount++;
+    return;
+  }
+
+  if (_fingerprint) {
+    // the signal is known even when not subscribed.
+    _fingerprint->known();
+  }
+
+  if (s->subRoot && (s->device < 0)) {
+    TRACE_MSG("  not subscribed: %s", s->seq);
+    s->rejectCount++;
+    return;
+  }
+
+  s->frameCount++;
+  _learnTrim(p, s);
+  _emitCode(p->name, s->seq, s->device, s->seqStart, s->seqEnd - s->seqStart, s->realBase);
 }  // _useCallback()
 
 
+/** pass a code to the queue or callback function with the position and number of its durations. */
+void SignalParser::_emitCode(const char *name, const char *seq, int device, unsigned long start, int length, CodeTime base) {
+  if (_queue) {
+    _queue->push(name, seq, device);
+
+  } else if (_callbackFunc) {
+    char code[PROTNAME_LEN + MAX_SEQUENCE_LENGTH + 1];
+    strcpy(code, name);
+    strcat(code, " ");
+    strcat(code, seq);
+    _device = device;
+    _frameStart = start;
+    _frameLength = length;
+    _frameBase = base;
+    _callbackFunc(code);
+    _frameLength = 0;
+    _frameBase = 0;
+  }
+}  // _emitCode()
+
+
+/** pass the reported fingerprint, the burst is followed by the given number of durations. */
+void SignalParser::_useFingerprint(int after) {
+  int len = _fingerprint->getLength();
+  _emitCode(SF_NAME, _fingerprint->getCode(), -1, _position - after - len, len, _fingerprint->getBase());
+}  // _useFingerprint()
+
+
 /** check if the duration fits for the protocol */
-void SignalParser::_parseProtocol(Protocol *p, CodeTime duration) {
-  Code *c = p->codes;
+void SignalParser::_parseProtocol(const Protocol *p, ProtState *s, CodeTime duration) {
+  const Code *c = p->codes;
+  CodeState *cs = s->codes;
   int cCnt = p->codeLength;
   bool anyValid = false;
   bool retryCandidate = false;
 
-  while (c && cCnt) {
+  if ((!s->active) && ((duration < s->filterMin) || (duration > s->filterMax))) {
+    // start prefilter: an idle protocol stays idle when no start code can begin with this duration.
+    return;
+  }
+
+  // marks are at the even positions of the sequence.
+  bool seqMark = !((_position - 1 - s->seqStart) & 1);
 
-    if (c->valid) {
+  while (cCnt) {
+
+    if (cs->valid) {
       // check if timing fits into this code
-      int8_t i = c->cnt;
+      int8_t i = cs->cnt;
       CodeType type = c->type;
       bool matched = false;  // until found that the new duration fits
 
+      // a start code begins with a mark.
+      bool mark = (s->seqLen > 0) ? seqMark : !(i & 1);
+      CodeTime d = duration;
+      if ((s->trim) && (duration < SP_MAXTIME)) {
+        long t = (long)duration + (mark ? -s->trim : s->trim);
+        d = (t < 1) ? 1 : toCodeTime(t);
+      }
+
       TRACE_MSG("check: %c", c->name);
 
-      if ((p->seqLen == 0) && !(type & START)) {
+      if ((s->seqLen == 0) && !(type & START)) {
         // codes other than start codes are nor acceptable as a first code in the sequence.
         // TRACE_MSG("  not start");
 
-      } else if ((p->seqLen > 0) && !(type & ANY)) {
+      } else if ((s->seqLen > 0) && !(type & ANY)) {
         // codes other than data and end codes are nor acceptable during receiving.
         // TRACE_MSG("  not data");
 
-      } else if ((duration < c->minTime[i]) || (duration > c->maxTime[i])) {
+      } else if ((d < cs->minTime[i]) || (d > cs->maxTime[i])) {
         // This timing is not matching.
         // TRACE_MSG("  no fitting timing");
 
-        if ((i == 1) && (p->seqLen == 0)) {
+        if ((i == 1) && (s->seqLen == 0)) {
           // reanalyze this duration as a first duration for starting.
           retryCandidate = true;
           // TRACE_MSG("  --retry");
@@ -126,63 +360,84 @@ void SignalParser::_parseProtocol(Protocol *p, CodeTime duration) {
 
       } else {
         matched = true;  // this code matches
-        c->total += duration;
+        cs->total += d;
+
+        if ((_trimLearn) && (s->seqLen > 0) && (c->time[i] <= SP_TRIM_FACTOR)) {
+          // the base time is known after the start code.
+          long dev = (long)d - (long)((unsigned long)s->realBase * c->time[i]);
+          cs->trimSum += (mark ? dev : -dev);
+          cs->trimCnt++;
+        }
 
       }  // if
 
-      // write back to code
-      c->valid = matched;
+      // write back to the code state
+      cs->valid = matched;
 
       anyValid = anyValid || matched;
+      if (matched) {
+        s->active = true;
+      }
 
       if (retryCandidate) {
         // reset this code only and try again.
         TRACE_MSG("  start retry...");
-        _resetProtocol(p);
+        _resetProtocol(p, s);
 
 
       } else if (matched) {
         // this timing is matching
         TRACE_MSG("  matched.");
-        c->cnt = i = i + 1;
+        cs->cnt = i = i + 1;
 
         if (i == c->timeLength) {
           // all timings received so add code-character.
-          if (p->seqLen == 0) {
-            TRACE_MSG("start: %s %d", p->name, c->total);
-            int allTimes = 0;
-            for (int tl = 0; tl < c->timeLength; tl++) {
-              allTimes += c->time[tl];
-            }
-            _recalcProtocol(p, c->total / allTimes);
+          if (s->seqLen == 0) {
+            TRACE_MSG("start: %s %d", p->name, cs->total);
+            s->startCount++;
+            s->seqStart = _position - c->timeLength;
+            s->trimSum = 0;
+            s->trimCnt = 0;
+          }
+          s->seqEnd = _position;
+          s->trimSum += cs->trimSum;
+          s->trimCnt += cs->trimCnt;
+          if (!(type & END)) {
+            _trackBase(p, s, c, cs);
           }
 
-          p->seq[p->seqLen++] = c->name;
-          p->seq[p->seqLen] = NUL;
+          s->seq[s->seqLen++] = c->name;
+          s->seq[s->seqLen] = NUL;
           // DEBUG_ESP_PORT.print(c->name);
-          TRACE_MSG("  add '%s'", p->seq);
+          TRACE_MSG("  add '%s'", s->seq);
+
+          _resetCodes(p, s);  // reset all codes but not the protocol
 
-          _resetCodes(p);  // reset all codes but not the protocol
+          if (!_validateCode(p, s)) {
+            // no valid sequence can be completed.
+            TRACE_MSG("  invalid: %s", s->seq);
+            s->rejectCount++;
+            _resetProtocol(p, s);
 
-          if ((type == END) && (p->seqLen < p->minCodeLen)) {
+          } else if ((type == END) && (s->seqLen < (int)p->minCodeLen)) {
             // End packet found but sequence was not started early enough
-            TRACE_MSG("  end fragment: %s", p->seq);
-            _resetProtocol(p);
-
-          } else if ((type & END) && (p->seqLen >= p->minCodeLen)) {
-            TRACE_MSG("  found-1: %s", p->seq);
-            _useCallback(p);
-            _resetProtocol(p);
-
-          } else if ((p->seqLen == p->maxCodeLen)) {
-            TRACE_MSG("  found-2: %s", p->seq);
-            _useCallback(p);
-            _resetProtocol(p);
+            TRACE_MSG("  end fragment: %s", s->seq);
+            _resetProtocol(p, s);
+
+          } else if ((type & END) && (s->seqLen >= (int)p->minCodeLen)) {
+            TRACE_MSG("  found-1: %s", s->seq);
+            _useCallback(p, s);
+            _resetProtocol(p, s);
+
+          } else if (s->seqLen == (int)p->maxCodeLen) {
+            TRACE_MSG("  found-2: %s", s->seq);
+            _useCallback(p, s);
+            _resetProtocol(p, s);
           }
           break;  // no more code checking in this protocol
         }         // if
       }
-    }  // if (c->valid)
+    }  // if (cs->valid)
 
     if (retryCandidate) {
       // only loop once
@@ -190,13 +445,14 @@ void SignalParser::_parseProtocol(Protocol *p, CodeTime duration) {
     } else {
       // next code
       c++;
+      cs++;
       cCnt--;
     }
   }  // while
 
   if (!anyValid) {
     TRACE_MSG("  no codes.");
-    _resetProtocol(p);
+    _resetProtocol(p, s);
   }
 }  // _parseProtocol()
 
@@ -204,37 +460,217 @@ void SignalParser::_parseProtocol(Protocol *p, CodeTime duration) {
 // ===== public functions =====
 
 
+/** free the protocol table, parsing states, subscriptions and the queue allocated by the parser. */
+SignalParser::~SignalParser() {
+  free(_protocol);
+  free(_state);
+  free(_bundleProt);
+  free(_bundleState);
+  free(_subNodes);
+  delete _ownQueue;
+}  // ~SignalParser()
+
+
 /** attach a callback function that will get passed any new code. */
 void SignalParser::attachCallback(CallbackFunction newFunction) {
   _callbackFunc = newFunction;
 }  // attachCallback()
 
 
+/** attach a queue that will get any new code instead of the callback function. */
+void SignalParser::attachQueue(SignalQueue *queue) {
+  _queue = queue;
+}  // attachQueue()
+
+
+/** use a queue owned by the parser for the decoded codes. */
+void SignalParser::enableQueue() {
+  if (!_ownQueue) {
+    _ownQueue = new SignalQueue();
+  }
+  _queue = _ownQueue;
+}  // enableQueue()
+
+
+/** pass all queued codes to the callback function. */
+int SignalParser::dispatch() {
+  int cnt = 0;
+
+  if (_queue) {
+    const char *code;
+    while ((code = _queue->peek())) {
+      if (_callbackFunc) {
+        _device = _queue->getDevice();
+        _callbackFunc(code);
+      }
+      _queue->pop();
+      cnt++;
+    }  // while
+  }
+  return (cnt);
+}  // dispatch()
+
+
 // return the number of send repeats that should occure.
 int SignalParser::getSendRepeat(char *name) {
-  Protocol *p = _findProt(name);
-  return (p ? p->sendRepeat : 0);
+  int n = _findProt(name);
+  return ((n >= 0) ? _getProt(n)->sendRepeat : 0);
 }
 
+// return the carrier frequency used for sending or 0 for no carrier.
+unsigned int SignalParser::getCarrier(char *name, unsigned int *dutyCycle) {
+  int n = _findProt(name);
+  if ((n >= 0) && dutyCycle) {
+    *dutyCycle = _getProt(n)->dutyCycle;
+  }
+  return ((n >= 0) ? _getProt(n)->carrier : 0);
+}  // getCarrier()
+
+
 /** parse a single duration.
  * @param duration check if this duration fits to any definitions.
  */
 void SignalParser::parse(CodeTime duration) {
   TRACE_MSG("(%d)", duration);
+  _position++;
 
-  for (int n = 0; n < _protocolCount; n++) {
-    _parseProtocol(_protocol[n], duration);
+  if (_bundle) {
+    for (int n = 0; n < _bundleCount; n++) {
+      _parseProtocol(&_bundle[n], &_bundleState[n], duration);
+    }
+  } else {
+    for (int n = 0; n < _protocolCount; n++) {
+      _parseProtocol(_protocol[n], &_state[n], duration);
+    }
+  }
+
+  // after the protocols so a sequence finished by this duration is known.
+  if ((_fingerprint) && (_fingerprint->add(duration))) {
+    _useFingerprint(1);
   }
 }  // parse()
 
 
+/** parse a block of durations, e.g. when replaying a capture. */
+void SignalParser::parse(const CodeTime *durations, int count) {
+  CodeTime filterMin[SCL_WINDOWS];
+  CodeTime filterMax[SCL_WINDOWS];
+  uint16_t masks[SP_BLOCKSIZE];
+
+  int protCount = _getProtCount();
+  int windows = (protCount < SCL_WINDOWS ? protCount : SCL_WINDOWS);
+
+  while (count > 0) {
+    uint16_t active = 0;  // bit n is set while protocol n is active
+
+    for (int n = 0; n < windows; n++) {
+      ProtState *s = _getState(n);
+      filterMin[n] = s->filterMin;
+      filterMax[n] = s->filterMax;
+      if (s->active) {
+        active |= (1 << n);
+      }
+    }  // for
+    _filterChanged = false;
+
+    int len = (count < SP_BLOCKSIZE ? count : SP_BLOCKSIZE);
+    SignalClassifier::classify(durations, len, filterMin, filterMax, windows, masks);
+
+    // the following durations are classified again when a start prefilter changed, e.g. by the trim.
+    int i;
+    for (i = 0; (i < len) && (!_filterChanged); i++) {
+      TRACE_MSG("(%d)", durations[i]);
+      _position++;
+
+      // only active protocols and protocols with a fitting start code are checked.
+      uint16_t check = masks[i] | active;
+      while (check) {
+        int n = __builtin_ctz(check);
+        check &= check - 1;
+
+        ProtState *s = _getState(n);
+        _parseProtocol(_getProt(n), s, durations[i]);
+        if (s->active) {
+          active |= (1 << n);
+        } else {
+          active &= ~(1 << n);
+        }
+      }  // while
+
+      // more protocols than windows are checked one by one.
+      for (int n = windows; n < protCount; n++) {
+        _parseProtocol(_getProt(n), _getState(n), durations[i]);
+      }
+
+      if ((_fingerprint) && (_fingerprint->add(durations[i]))) {
+        _useFingerprint(1);
+      }
+    }  // for
+
+    durations += i;
+    count -= i;
+  }  // while
+}  // parse()
+
+
+/** return the position of the oldest duration that may be part of a sequence not finished yet. */
+unsigned long SignalParser::getOldestPosition() {
+  unsigned long oldest = _position;
+
+  for (int n = 0; n < _getProtCount(); n++) {
+    ProtState *s = _getState(n);
+    if (s->active) {
+      // a start code that is not complete started within the last MAX_TIMELENGTH durations.
+      unsigned long pos = (s->seqLen ? s->seqStart : _position - MAX_TIMELENGTH);
+      if ((_position - pos) > (_position - oldest)) {
+        oldest = pos;
+      }
+    }
+  }  // for
+
+  if (_fingerprint) {
+    // the durations of the current burst may become a fingerprint.
+    unsigned long pos = _position - _fingerprint->getBurstLength();
+    if ((_position - pos) > (_position - oldest)) {
+      oldest = pos;
+    }
+  }
+  return (oldest);
+}  // getOldestPosition()
+
+
+/** finish all started sequences when no more timings will follow. */
+int SignalParser::flush() {
+  int cnt = 0;
+
+  for (int n = 0; n < _getProtCount(); n++) {
+    const Protocol *p = _getProt(n);
+    ProtState *s = _getState(n);
+    if (s->active) {
+      if ((s->seqLen > 0) && (s->seqLen >= (int)p->minCodeLen)) {
+        TRACE_MSG("  found-3: %s", s->seq);
+        _useCallback(p, s);
+        cnt++;
+      }
+      _resetProtocol(p, s);
+    }
+  }  // for
+
+  if ((_fingerprint) && (_fingerprint->flush())) {
+    _useFingerprint(0);
+    cnt++;
+  }
+  return (cnt);
+}  // flush()
+
+
 /** compose the timings of a sequence by using the code table.
  * @param sequence textual representation using "<protocolname> <codes>".
  */
 void SignalParser::compose(const char *sequence, CodeTime *timings, int len) {
   char protname[PROTNAME_LEN];
 
-  char *s = strchr(sequence, ' ');
+  const char *s = strchr(sequence, ' ');
 
   if (s) {
     // extract protname
@@ -246,20 +682,35 @@ void SignalParser::compose(const char *sequence, CodeTime *timings, int len) {
       }
       *tar = NUL;
     }
-    Protocol *p = _findProt(protname);
+    int n = _findProt(protname);
 
     s++;  // to start of code characters
 
-    if (p && timings) {
-      while (*s && len) {
-        Code *c = _findCode(p, *s);
+    if ((n >= 0) && timings && (len > 0)) {
+      const Protocol *p = _getProt(n);
+      int trim = _getState(n)->trim;
+      len--;  // keep space for final 0
+      bool mark = true;  // sending starts with a mark
+      while (*s) {
+        const Code *c = _findCode(p, *s);
         if (c) {
+          if (c->timeLength > len)
+            break;
           for (int i = 0; i < c->timeLength; i++) {
-            *timings++ = (c->minTime[i] + c->maxTime[i]) / 2;
+            // use the nominal timing as the windows may be adjusted while parsing.
+            long t = (long)p->baseTime * c->time[i];
+            if ((trim) && (t < SP_MAXTIME)) {
+              // the receiver will stretch the marks by the trim.
+              t += (mark ? -trim : trim);
+              if (t < 1)
+                t = 1;
+            }
+            *timings++ = toCodeTime(t);
+            mark = !mark;
           }  // for
+          len -= c->timeLength;
         }
         s++;
-        len--;
       }
       *timings = 0;
     }  // if
@@ -267,36 +718,125 @@ void SignalParser::compose(const char *sequence, CodeTime *timings, int len) {
 }  // compose()
 
 
-void SignalParser::_recalcProtocol(Protocol *protocol, CodeTime baseTime) {
-  // calc min and max and codesLength
-  if (protocol->baseTime != baseTime) {
-    TRACE_MSG("recalc %d", baseTime);
+/** calculate the windows of the codes for the base time of the protocol or the range up to otherBase. */
+void SignalParser::_calcProtocol(Protocol *protocol) {
+  // the windows span from the lower to the upper base time.
+  CodeTime lowBase = protocol->baseTime;
+  CodeTime highBase = protocol->baseTime;
+  if (protocol->otherBase > protocol->baseTime) {
+    highBase = protocol->otherBase;
+  } else if (protocol->otherBase) {
+    lowBase = protocol->otherBase;
   }
 
   for (int cl = 0; cl < protocol->codeLength; cl++) {
     Code *c = &(protocol->codes[cl]);
 
     for (int tl = 0; tl < c->timeLength; tl++) {
-      CodeTime t = baseTime * c->time[tl];
-      int radius = (t * protocol->tolerance) / 100;
-      c->minTime[tl] = t - radius;
-      c->maxTime[tl] = t + radius;
+      _calcWindow(c->time[tl], lowBase, highBase, protocol->tolerance, &c->minTime[tl], &c->maxTime[tl]);
     }
   }
-}  // _recalcProtocol()
+}  // _calcProtocol()
+
+
+/** recalculate the windows of the codes in the parsing state for a tracked base time. */
+void SignalParser::_recalcState(const Protocol *p, ProtState *s, CodeTime baseTime) {
+  if (p->baseTime != baseTime) {
+    TRACE_MSG("recalc %d", baseTime);
+  }
+  s->realBase = baseTime;
+
+  for (int cl = 0; cl < p->codeLength; cl++) {
+    const Code *c = &(p->codes[cl]);
+    CodeState *cs = &(s->codes[cl]);
+
+    for (int tl = 0; tl < c->timeLength; tl++) {
+      _calcWindow(c->time[tl], baseTime, baseTime, p->tolerance, &cs->minTime[tl], &cs->maxTime[tl]);
+    }
+  }
+}  // _recalcState()
+
+
+/** calculate the window of a time factor for the base times lowBase to highBase. */
+void SignalParser::_calcWindow(unsigned long time, CodeTime lowBase, CodeTime highBase, unsigned int tolerance,
+                               CodeTime *minTime, CodeTime *maxTime) {
+  unsigned long low = lowBase * time;
+  unsigned long high = highBase * time;
+  // windows reaching beyond SP_MAXTIME accept saturated long gaps.
+  *minTime = toCodeTime(low - (low * tolerance) / 100);
+  *maxTime = toCodeTime(high + (high * tolerance) / 100);
+}  // _calcWindow()
+
+
+/** Return the windows of the timings of the first start code of a protocol. */
+int SignalParser::getStartWindows(const char *name, CodeTime *minTime, CodeTime *maxTime, int len) {
+  int n = _findProt(name);
+
+  if (n >= 0) {
+    const Protocol *p = _getProt(n);
+    int trim = _getState(n)->trim;
+
+    for (int cl = 0; cl < p->codeLength; cl++) {
+      const Code *c = &(p->codes[cl]);
+      if ((c->type & START) && (c->timeLength <= len)) {
+        for (int tl = 0; tl < c->timeLength; tl++) {
+          // the windows of the received durations include the trim.
+          long t = (tl & 1) ? -trim : trim;
+          long lo = (long)c->minTime[tl] + t;
+          long hi = (long)c->maxTime[tl] + t;
+          minTime[tl] = (lo < 0) ? 0 : toCodeTime(lo);
+          maxTime[tl] = (hi < 0) ? 0 : toCodeTime(hi);
+        }
+        return (c->timeLength);
+      }
+    }  // for
+  }
+  return (0);
+}  // getStartWindows()
+
+
+/** Set the trim of all protocols. */
+void SignalParser::setTrim(int trim) {
+  if (_locked) {
+    ERROR_MSG("setTrim not possible while locked");
+    return;
+  }
+
+  _trim = trim;
+  for (int n = 0; n < _protocolCount; n++) {
+    _state[n].trim = trim;
+    _state[n].trimTrack = (long)trim * (1 << SP_BASE_FRACT);
+    _calcStartFilter(_protocol[n], &_state[n]);
+  }  // for
+  for (int n = 0; n < _bundleCount; n++) {
+    _bundleState[n].trim = trim;
+    _bundleState[n].trimTrack = (long)trim * (1 << SP_BASE_FRACT);
+    _calcStartFilter(&_bundle[n], &_bundleState[n]);
+  }  // for
+}  // setTrim()
+
+
+/** Return the trim of a protocol in µsecs. */
+int SignalParser::getTrim(const char *name) {
+  int n = _findProt(name);
+  return ((n >= 0) ? _getState(n)->trim : 0);
+}  // getTrim()
 
 
 /** Load a protocol to be used. */
-// @param otherBaseTime not in use yet.
 void SignalParser::load(Protocol *protocol, CodeTime otherBaseTime) {
-  if (protocol) {
+  if (_locked) {
+    ERROR_MSG("load not possible while locked");
+
+  } else if (protocol) {
     TRACE_MSG("loading protocol %s", protocol->name);
 
-    // get space for protocol definition
+    // get space for protocol definition and parsing state
     if (_protocolCount >= _protocolAlloc) {
       _protocolAlloc += 8;
       TRACE_MSG("alloc %d", _protocolAlloc);
       _protocol = (Protocol **)realloc(_protocol, _protocolAlloc * sizeof(Protocol *));
+      _state = (ProtState *)realloc(_state, _protocolAlloc * sizeof(ProtState));
     }
 
     // fill last one.
@@ -304,24 +844,8 @@ void SignalParser::load(Protocol *protocol, CodeTime otherBaseTime) {
     TRACE_MSG("_p[%d]=%08x", _protocolCount, protocol);
     _protocolCount += 1;
 
-    CodeTime baseTime = protocol->baseTime;
-
-    // calc c->timeLength and p->codeLength
-    int cl = 0;
-    while ((cl < MAX_CODELENGTH) && (protocol->codes[cl].name)) {
-      Code *c = &(protocol->codes[cl]);
-
-      int tl = 0;
-      while ((tl < MAX_TIMELENGTH) && (c->time[tl])) {
-        tl++;
-      }  // while
-      c->timeLength = tl;
-      cl++;
-    }                           // while
-    protocol->codeLength = cl;  // no need to specify codeLength
-
-    _recalcProtocol(protocol, baseTime);
-    _resetProtocol(protocol);
+    _prepareProtocol(protocol, otherBaseTime);
+    _initState(protocol, &_state[_protocolCount - 1]);
 
     for (int n = 0; n < _protocolCount; n++) {
       TRACE_MSG(" reg[%d] = %08x", n, _protocol[n]);
@@ -331,4 +855,310 @@ void SignalParser::load(Protocol *protocol, CodeTime otherBaseTime) {
   }  // if
 }  // load()
 
-// End.
\ No newline at end of file
+
+/** calculate all members of a protocol that are calculated by load(). */
+void SignalParser::_prepareProtocol(Protocol *protocol, CodeTime otherBaseTime) {
+  // calc c->timeLength and p->codeLength
+  int cl = 0;
+  while ((cl < MAX_CODELENGTH) && (protocol->codes[cl].name)) {
+    Code *c = &(protocol->codes[cl]);
+
+    int tl = 0;
+    c->timeSum = 0;
+    while ((tl < MAX_TIMELENGTH) && (c->time[tl])) {
+      c->timeSum += c->time[tl];
+      tl++;
+    }  // while
+    c->timeLength = tl;
+    cl++;
+  }                           // while
+  protocol->codeLength = cl;  // no need to specify codeLength
+  protocol->patternLen = strnlen(protocol->pattern, SP_PATTERN_LEN - 1);
+  protocol->otherBase = (otherBaseTime != protocol->baseTime) ? otherBaseTime : 0;
+
+  _calcProtocol(protocol);
+}  // _prepareProtocol()
+
+
+/** Subscribe to code sequences of a protocol starting with a prefix. */
+bool SignalParser::subscribe(const char *name, const char *prefix, int device) {
+  int pn = _findProt(name);
+
+  if ((pn < 0) || (!prefix) || (!*prefix) || (device < 0) || (device > 0x7FFF)) {
+    return (false);
+  }
+
+  if (_locked) {
+    // the trie may be reallocated.
+    ERROR_MSG("subscribe not possible while locked");
+    return (false);
+  }
+
+  ProtState *s = _getState(pn);
+  if (!s->subRoot) {
+    s->subRoot = _subNew(NUL);
+  }
+
+  uint16_t n = s->subRoot;
+  while (n && *prefix) {
+    n = _subChild(n, *prefix++);
+  }
+  if (!n) {
+    ERROR_MSG("too many subscriptions");
+    return (false);
+  }
+
+  _subNodes[n].device = device;
+  _resetProtocol(_getProt(pn), s);
+  return (true);
+}  // subscribe()
+
+
+/** Remove all subscriptions so all sequences are passed to the callback again. */
+bool SignalParser::clearSubscriptions() {
+  if (_locked) {
+    ERROR_MSG("clearSubscriptions not possible while locked");
+    return (false);
+  }
+
+  for (int n = 0; n < _protocolCount; n++) {
+    _state[n].subRoot = 0;
+    _resetProtocol(_protocol[n], &_state[n]);
+  }
+  for (int n = 0; n < _bundleCount; n++) {
+    _bundleState[n].subRoot = 0;
+    _resetProtocol(&_bundle[n], &_bundleState[n]);
+  }
+
+  free(_subNodes);
+  _subNodes = nullptr;
+  _subAlloc = 0;
+  _subCount = 0;
+  return (true);
+}  // clearSubscriptions()
+
+
+/** store a number little-endian into len bytes of a bundle. */
+static void _putBytes(uint8_t *b, unsigned long value, int len) {
+  for (int n = 0; n < len; n++) {
+    b[n] = (uint8_t)(value >> (8 * n));
+  }
+}  // _putBytes()
+
+
+/** read a number stored little-endian in len bytes of a bundle. */
+static unsigned long _getBytes(const uint8_t *b, int len) {
+  unsigned long value = 0;
+  for (int n = len - 1; n >= 0; n--) {
+    value = (value << 8) | b[n];
+  }
+  return (value);
+}  // _getBytes()
+
+
+/** return the size of the bundle record of a protocol. */
+size_t SignalParser::_recordSize(const Protocol *p) {
+  size_t size = sizeof(BundleRecord);
+  for (int cl = 0; cl < p->codeLength; cl++) {
+    size += sizeof(BundleCode) + 2 * p->codes[cl].timeLength;
+  }
+  return (size);
+}  // _recordSize()
+
+
+/** write the bundle record of a protocol, returns the size of the record. */
+size_t SignalParser::_writeRecord(const Protocol *p, uint8_t *rec) {
+  BundleRecord *r = (BundleRecord *)rec;
+
+  memset(r, 0, sizeof(BundleRecord));
+  memcpy(r->name, p->name, PROTNAME_LEN - 1);
+  _putBytes(r->minCodeLen, p->minCodeLen, 2);
+  _putBytes(r->maxCodeLen, p->maxCodeLen, 2);
+  _putBytes(r->tolerance, p->tolerance, 2);
+  _putBytes(r->sendRepeat, p->sendRepeat, 2);
+  _putBytes(r->baseTime, p->baseTime, 2);
+  _putBytes(r->otherBase, p->otherBase, 2);
+  _putBytes(r->carrier, p->carrier, 4);
+  _putBytes(r->dutyCycle, p->dutyCycle, 2);
+  r->codeLength = p->codeLength;
+  memcpy(r->pattern, p->pattern, SP_PATTERN_LEN - 1);
+
+  // only the codes and time factors in use are stored.
+  uint8_t *b = rec + sizeof(BundleRecord);
+  for (int cl = 0; cl < p->codeLength; cl++) {
+    const Code *c = &(p->codes[cl]);
+    BundleCode *bc = (BundleCode *)b;
+    bc->type = c->type;
+    bc->name = c->name;
+    bc->timeLength = c->timeLength;
+    b += sizeof(BundleCode);
+    for (int i = 0; i < c->timeLength; i++) {
+      _putBytes(b, c->time[i], 2);
+      b += 2;
+    }
+  }  // for
+  return (b - rec);
+}  // _writeRecord()
+
+
+/** read and check a bundle record of at most len bytes into a protocol. */
+size_t SignalParser::_readRecord(const uint8_t *rec, size_t len, Protocol *p) {
+  const BundleRecord *r = (const BundleRecord *)rec;
+
+  if ((len < sizeof(BundleRecord))
+      || (!memchr(r->name, NUL, PROTNAME_LEN))
+      || (!memchr(r->pattern, NUL, SP_PATTERN_LEN))
+      || (r->codeLength < 1) || (r->codeLength > MAX_CODELENGTH)) {
+    return (0);
+  }
+
+  memset(p, 0, sizeof(Protocol));
+  strcpy(p->name, r->name);
+  p->minCodeLen = _getBytes(r->minCodeLen, 2);
+  p->maxCodeLen = _getBytes(r->maxCodeLen, 2);
+  p->tolerance = _getBytes(r->tolerance, 2);
+  p->sendRepeat = _getBytes(r->sendRepeat, 2);
+  p->baseTime = _getBytes(r->baseTime, 2);
+  p->otherBase = _getBytes(r->otherBase, 2);
+  p->carrier = _getBytes(r->carrier, 4);
+  p->dutyCycle = _getBytes(r->dutyCycle, 2);
+  strcpy(p->pattern, r->pattern);
+
+  // a sequence of maxCodeLen codes and the ending '\0' must fit into ProtState::seq.
+  if ((p->maxCodeLen < 1) || (p->maxCodeLen >= MAX_SEQUENCE_LENGTH) || (p->baseTime == 0)) {
+    return (0);
+  }
+
+  size_t pos = sizeof(BundleRecord);
+  for (int cl = 0; cl < r->codeLength; cl++) {
+    if (len < pos + sizeof(BundleCode))
+      return (0);
+    const BundleCode *bc = (const BundleCode *)(rec + pos);
+    pos += sizeof(BundleCode);
+
+    // the lengths are calculated again from the names and times like in load().
+    if ((!bc->name) || (bc->timeLength < 1) || (bc->timeLength > MAX_TIMELENGTH) || (len < pos + 2 * bc->timeLength))
+      return (0);
+
+    Code *c = &(p->codes[cl]);
+    c->type = (CodeType)bc->type;
+    c->name = bc->name;
+    for (int i = 0; i < bc->timeLength; i++) {
+      c->time[i] = _getBytes(rec + pos, 2);
+      pos += 2;
+      if (!c->time[i])
+        return (0);
+    }
+  }  // for
+  return (pos);
+}  // _readRecord()
+
+
+/** Return the size of a bundle containing the loaded protocols. */
+size_t SignalParser::getBundleSize() {
+  size_t size = SP_BUNDLE_HEADERSIZE;
+  for (int n = 0; n < _protocolCount; n++) {
+    size += _recordSize(_protocol[n]);
+  }
+  return (size);
+}  // getBundleSize()
+
+
+/** Write the loaded protocols into a bundle. */
+size_t SignalParser::saveBundle(void *buffer, size_t len) {
+  size_t size = getBundleSize();
+
+  if ((!buffer) || (len < size))
+    return (0);
+
+  for (int n = 0; n < _protocolCount; n++) {
+    if (_protocol[n]->validate) {
+      // a function pointer is not valid in another program.
+      ERROR_MSG("protocol %s with a validate function cannot be saved", _protocol[n]->name);
+      return (0);
+    }
+  }  // for
+
+  memset(buffer, 0, SP_BUNDLE_HEADERSIZE);
+  BundleHeader *h = (BundleHeader *)buffer;
+  memcpy(h->magic, SP_BUNDLE_MAGIC, sizeof(h->magic));
+  _putBytes(h->version, SP_BUNDLE_VERSION, 2);
+  _putBytes(h->count, _protocolCount, 2);
+  _putBytes(h->size, size, 4);
+
+  uint8_t *rec = (uint8_t *)buffer + SP_BUNDLE_HEADERSIZE;
+  for (int n = 0; n < _protocolCount; n++) {
+    rec += _writeRecord(_protocol[n], rec);
+  }  // for
+  return (size);
+}  // saveBundle()
+
+
+/** Use the protocols of a bundle instead of the loaded protocols. */
+bool SignalParser::useBundle(const void *bundle, size_t len) {
+  const BundleHeader *h = (const BundleHeader *)bundle;
+
+  if (_locked) {
+    ERROR_MSG("useBundle not possible while locked");
+    return (false);
+  }
+
+  _bundle = nullptr;
+  _bundleCount = 0;
+
+  if (!h) {
+    // use the loaded protocols again.
+    return (false);
+  }
+
+  if ((len < SP_BUNDLE_HEADERSIZE)
+      || (memcmp(h->magic, SP_BUNDLE_MAGIC, sizeof(h->magic)) != 0)
+      || (_getBytes(h->version, 2) != SP_BUNDLE_VERSION)
+      || (_getBytes(h->size, 4) > len)) {
+    ERROR_MSG("invalid protocol bundle");
+    return (false);
+  }
+  len = _getBytes(h->size, 4);
+  int count = _getBytes(h->count, 2);
+
+  // get space for the protocols and their parsing state.
+  if (count > _bundleAlloc) {
+    Protocol *prot = (Protocol *)realloc(_bundleProt, count * sizeof(Protocol));
+    if (prot) {
+      _bundleProt = prot;
+    }
+    ProtState *state = (ProtState *)realloc(_bundleState, count * sizeof(ProtState));
+    if (state) {
+      _bundleState = state;
+    }
+    if ((!prot) || (!state)) {
+      ERROR_MSG("no memory for the protocol bundle");
+      return (false);
+    }
+    _bundleAlloc = count;
+  }
+
+  // every record is checked before the protocols are used.
+  size_t pos = SP_BUNDLE_HEADERSIZE;
+  for (int n = 0; n < count; n++) {
+    Protocol *p = &_bundleProt[n];
+    size_t size = _readRecord((const uint8_t *)bundle + pos, len - pos, p);
+    if (!size) {
+      ERROR_MSG("invalid protocol %d in bundle", n);
+      return (false);
+    }
+    pos += size;
+    _prepareProtocol(p, p->otherBase);
+  }  // for
+
+  // subscriptions are not part of a bundle.
+  for (int n = 0; n < count; n++) {
+    _initState(&_bundleProt[n], &_bundleState[n]);
+  }  // for
+
+  _bundle = _bundleProt;
+  _bundleCount = count;
+  return (true);
+}  // useBundle()
+
+// End.
@@ -16,6 +16,28 @@
  * Changelog:
  * * 29.04.2018 created by Matthias Hertel
  * * 06.08.2018 const char send, allow for sending only.
+ * * 18.10.2026 track the base time with every received code.
+ * * 18.10.2026 16-bit CodeTime with saturating long gaps.
+ * * 18.10.2026 decoded sequences can be passed through a SignalQueue.
+ * * 18.10.2026 the parser can own a queue to decouple the callback from parsing.
+ * * 18.10.2026 protocol bundles with precalculated protocols can be used in place.
+ * * 18.10.2026 idle protocols only check the range of the start codes.
+ * * 18.10.2026 flush() finishes sequences after a timeout.
+ * * 18.10.2026 carrier frequency and duty cycle for sending IR protocols.
+ * * 18.10.2026 incremental validation of sequences while receiving.
+ * * 18.10.2026 subscriptions of code prefixes with device ids.
+ * * 18.10.2026 parse blocks of durations using the SignalClassifier.
+ * * 18.10.2026 position of the durations of the sequence passed to the callback.
+ * * 18.10.2026 protocols can be loaded with a range of base times.
+ * * 18.10.2026 start code windows for capture triggers.
+ * * 18.10.2026 trim of marks and spaces learned from received sequences.
+ * * 18.10.2026 fingerprints of unknown signals.
+ * * 18.10.2026 parsing state kept in RAM, protocol records and bundles are only read.
+ * * 18.10.2026 the range of the start codes is named start prefilter.
+ * * 18.10.2026 the pattern is stored in the protocol, bundles contain no pointers.
+ * * 18.10.2026 changes can be locked while parsing in another task or thread.
+ * * 18.10.2026 block parsing classifies again after the start prefilter changed.
+ * * 18.10.2026 bundles use a portable format with the codes in use.
  */
 
 // .h
@@ -36,11 +58,15 @@
 // #include <cstdint>
 // #include <cstdlib>
 // #include <cstring >
+#include <stdint.h>
 
 #include "debugout.h"
 
 #define NUL '\0'
 
+class SignalQueue;
+class SignalFingerprint;
+
 #define MAX_TIMELENGTH 8  // maximal length of a code definition
 #define MAX_CODELENGTH 8  // maximal number of code definitions per protocol
 
@@ -48,6 +74,21 @@
 #define MAX_TIMING_LENGTH (MAX_TIMELENGTH * MAX_SEQUENCE_LENGTH)  // maximal number of timings in a sequence
 
 #define PROTNAME_LEN 12  // maximal protocol name len including ending '\0'
+#define SP_PATTERN_LEN 16  // maximal pattern len including ending '\0'
+
+#define SP_MAXTIME 0xFFFF  // maximal duration of a CodeTime, longer gaps are saturated to this value.
+
+#define SP_BUNDLE_MAGIC "RFCB"  // identification of a protocol bundle
+#define SP_BUNDLE_VERSION 12    // version of the bundle format
+#define SP_BUNDLE_HEADERSIZE 16 // offset of the first protocol in a bundle
+
+#define SP_BASE_FRACT 4  // fractional bits of the tracked base time (1/16 µsecs)
+#define SP_BASE_GAIN 4   // the tracked base time follows each code by 1/SP_BASE_GAIN of the deviation
+
+#define SP_TRIM_GAIN 4    // the learned trim follows each sequence by 1/SP_TRIM_GAIN of the deviation
+#define SP_TRIM_FACTOR 4  // only timings up to this factor of the base time are used to learn the trim
+
+#define SP_BLOCKSIZE 256  // number of durations classified at once when parsing a block
 
 class SignalParser {
 public:
@@ -64,10 +105,11 @@ public:
   } CodeType;
 
   // timings are using CodeTime datatypes meaning µsecs.
-  typedef unsigned int CodeTime;
+  // Durations longer than SP_MAXTIME are saturated to SP_MAXTIME.
+  typedef uint16_t CodeTime;
 
   // The Code structure is used to hold a specific timing sequence used in the protocol.
-  // This Structure includes also the current state information while receiving the code.
+  // It is not changed while parsing, the state of receiving the code is kept in a CodeState.
   struct Code {
     CodeType type;  // type of usage of code
     char name;      // single character name for this code used for the message string.
@@ -77,16 +119,18 @@ public:
     // These members will be calculated:
 
     int timeLength;  // number of timings for this code
-    CodeTime total;       // total time in this code
+    int timeSum;     // sum of all time factors in this code
 
-    CodeTime minTime[MAX_TIMELENGTH];  // average time of the code part.
-    CodeTime maxTime[MAX_TIMELENGTH];  // average time of the code part.
+    CodeTime minTime[MAX_TIMELENGTH];  // minimal time of the code part for the base time.
+    CodeTime maxTime[MAX_TIMELENGTH];  // maximal time of the code part for the base time.
+  };                                   // struct Code
 
-    // these fields reflect the current status of the code.
-    int cnt;     // number of discovered timings.
-    bool valid;  // is true while discovering and the code is still possible.
-  };             // struct Code
 
+  // Function to validate a sequence while receiving.
+  // It is called after every code added to the sequence with complete=false and may keep a state in check
+  // that is 0 when a sequence starts. It is called with complete=true before a sequence is passed on.
+  // Returning false drops the sequence immediately.
+  typedef bool (*ValidateFunction)(const char *seq, int seqLen, unsigned long *check, bool complete);
 
   // The Protocol structure is used to hold the basic settings for a protocol.
   struct Protocol {
@@ -108,17 +152,150 @@ public:
     unsigned int sendRepeat;
 
     CodeTime baseTime;
-    CodeTime realBase;
 
     Code codes[MAX_CODELENGTH];
 
-    // ===== These members are used while parsing:
+    // carrier frequency in Hz that is switched on during the high timings when sending.
+    // 0 = no carrier, the output is just switched on (RF modules).
+    unsigned int carrier;
+
+    // duty cycle of the carrier in percent.
+    unsigned int dutyCycle;
+
+    // optional codes required at the start of a sequence, '?' for any code.
+    char pattern[SP_PATTERN_LEN];
+
+    // optional function to validate the sequence while receiving.
+    // Protocols with a validate function cannot be saved in a bundle.
+    ValidateFunction validate;
+
+    // ===== These members are calculated by load():
 
     // Number of defined codes in this table
     int codeLength;
+
+    // other end of the range of base times used by senders or 0 for only one base time.
+    CodeTime otherBase;
+
+    // length of the pattern.
+    int patternLen;
+  };  // struct Protocol
+
+
+  // The state of receiving a code, kept by the parser in RAM.
+  struct CodeState {
+    CodeTime minTime[MAX_TIMELENGTH];  // minimal time of the code part for the tracked base time.
+    CodeTime maxTime[MAX_TIMELENGTH];  // maximal time of the code part for the tracked base time.
+
+    unsigned long total;  // total time in this code
+
+    long trimSum;  // sum of the deviations of the marks minus the deviations of the spaces.
+    int trimCnt;   // number of timings in trimSum.
+
+    int8_t cnt;  // number of discovered timings.
+    bool valid;  // is true while discovering and the code is still possible.
+  };             // struct CodeState
+
+
+  // The state of parsing a protocol, kept by the parser in RAM for every protocol in use
+  // so the Protocol records are never written while parsing.
+  struct ProtState {
+    CodeState codes[MAX_CODELENGTH];
+
     char seq[MAX_SEQUENCE_LENGTH];
     int seqLen;
-  };  // struct Protocol
+
+    // base time the windows in codes are calculated for.
+    CodeTime realBase;
+
+    // base time recovered from the received codes in 1/(2^SP_BASE_FRACT) µsecs.
+    unsigned long baseTrack;
+
+    // state of the validate function, e.g. a checksum.
+    unsigned long check;
+
+    // root and current node in the subscription trie, 0 = no subscriptions.
+    uint16_t subRoot;
+    uint16_t subNode;
+
+    // device id of the matching subscription or -1.
+    int device;
+
+    // position of the first duration and after the last duration of the sequence.
+    unsigned long seqStart;
+    unsigned long seqEnd;
+
+    // marks are received longer and spaces shorter by this time in µsecs.
+    // Received durations are corrected before parsing and composed timings are corrected for sending.
+    int trim;
+
+    // trim learned from the accepted sequences in 1/(2^SP_BASE_FRACT) µsecs.
+    long trimTrack;
+
+    // deviations of the marks and spaces in the current sequence, see CodeState.
+    long trimSum;
+    int trimCnt;
+
+    // Start prefilter: range of the first timing of all start codes including the trim.
+    // It only depends on the protocol definition and the trim, not on the received traffic.
+    CodeTime filterMin;
+    CodeTime filterMax;
+
+    // is true while a start code or sequence is received.
+    // Idle protocols are skipped for all durations outside the start prefilter.
+    bool active;
+
+    // ===== Statistics
+
+    unsigned long startCount;  // number of detected start codes.
+    unsigned long frameCount;  // number of detected sequences.
+    unsigned long rejectCount; // number of sequences dropped by the validation or subscriptions.
+  };  // struct ProtState
+
+
+  // A protocol bundle starts with this header followed by the protocol records at the offset SP_BUNDLE_HEADERSIZE.
+  // The structures of a bundle only contain bytes and numbers are stored little-endian
+  // so a bundle created on one platform can be used on any other platform.
+  struct BundleHeader {
+    char magic[4];         // SP_BUNDLE_MAGIC without ending '\0'
+    uint8_t version[2];    // SP_BUNDLE_VERSION
+    uint8_t count[2];      // number of protocol records
+    uint8_t size[4];       // size of the bundle including the header
+    uint8_t reserved[4];
+  };  // struct BundleHeader
+
+  // A protocol record of a bundle is followed by codeLength code records.
+  // It contains no pointers and no calculated windows, they are calculated by useBundle().
+  struct BundleRecord {
+    char name[PROTNAME_LEN];
+    uint8_t minCodeLen[2];
+    uint8_t maxCodeLen[2];
+    uint8_t tolerance[2];
+    uint8_t sendRepeat[2];
+    uint8_t baseTime[2];
+    uint8_t otherBase[2];
+    uint8_t carrier[4];
+    uint8_t dutyCycle[2];
+    uint8_t codeLength;
+    char pattern[SP_PATTERN_LEN];
+  };  // struct BundleRecord
+
+  // A code record of a bundle is followed by timeLength time factors of 2 bytes each.
+  struct BundleCode {
+    uint8_t type;
+    char name;
+    uint8_t timeLength;
+  };  // struct BundleCode
+
+
+  // A node in the subscription trie with the first child and the next sibling.
+  // Node 0 is not used so 0 marks the end of a list.
+  struct SubNode {
+    char name;       // code name
+    uint16_t child;  // first node of the following codes
+    uint16_t next;   // next node with the same prefix
+    int16_t device;  // device id when a subscription ends here or -1
+  };  // struct SubNode
 
 
   // Callback when a code sequence was detected.
@@ -131,69 +308,359 @@ private:
   // ===== class variables =====
 
   /** Protocol table and related settings */
-  Protocol **_protocol;
+  Protocol **_protocol = nullptr;
   int _protocolAlloc = 0;
   int _protocolCount = 0;
 
-  CallbackFunction _callbackFunc;
+  /** parsing state of the protocols in the protocol table. */
+  ProtState *_state = nullptr;
+
+  /** Protocols of the bundle in use instead of the protocol table or nullptr. */
+  const Protocol *_bundle = nullptr;
+  int _bundleCount = 0;
+
+  /** protocols read from the bundle and their parsing state. */
+  Protocol *_bundleProt = nullptr;
+  ProtState *_bundleState = nullptr;
+  int _bundleAlloc = 0;
+
+  /** return the protocol number n of the bundle or the protocol table. */
+  const Protocol *_getProt(int n) {
+    return (_bundle ? &_bundle[n] : _protocol[n]);
+  }
+
+  /** return the parsing state of the protocol number n. */
+  ProtState *_getState(int n) {
+    return (_bundle ? &_bundleState[n] : &_state[n]);
+  }
+
+  /** return the number of protocols in use. */
+  int _getProtCount() {
+    return (_bundle ? _bundleCount : _protocolCount);
+  }
+
+  CallbackFunction _callbackFunc = nullptr;
+
+  /** queue for decoded sequences instead of using the callback directly. */
+  SignalQueue *_queue = nullptr;
+
+  /** queue allocated by enableQueue(). */
+  SignalQueue *_ownQueue = nullptr;
+
+  /** fingerprints of signals not decoded by any protocol. */
+  SignalFingerprint *_fingerprint = nullptr;
+
+  /** subscription trie of all protocols. */
+  SubNode *_subNodes = nullptr;
+  int _subAlloc = 0;
+  int _subCount = 0;
+
+  /** device id of the code sequence passed to the callback function. */
+  int _device = -1;
+
+  /** number of parsed durations, the position of the next duration. */
+  unsigned long _position = 0;
+
+  /** position and number of the durations of the code sequence passed to the callback function. */
+  unsigned long _frameStart = 0;
+  int _frameLength = 0;
+
+  /** base time recovered from the code sequence passed to the callback function. */
+  CodeTime _frameBase = 0;
+
+  /** trim used for protocols loaded later. */
+  int _trim = 0;
 
-  /** find protocol by name */
-  Protocol *_findProt(char *name);
+  /** is true when the trim is learned from the accepted sequences. */
+  bool _trimLearn = false;
+
+  /** is set when a start prefilter was calculated again, e.g. by a learned trim. */
+  bool _filterChanged = false;
+
+  /** is true while the protocols, subscriptions and trim must not be changed, see lockChanges(). */
+  bool _locked = false;
+
+  /** add a new node to the subscription trie, returns 0 when full. */
+  uint16_t _subNew(char name);
+
+  /** return the child node of n with the code name or create a new one. */
+  uint16_t _subChild(uint16_t n, char name);
+
+  /** find protocol by name, returns the number of the protocol or -1. */
+  int _findProt(const char *name);
 
   /** find code by name */
-  Code *_findCode(Protocol *p, char codeName);
+  const Code *_findCode(const Protocol *p, char codeName);
 
   /** reset all codes in a protocol */
-  void _resetCodes(Protocol *p);
+  void _resetCodes(const Protocol *p, ProtState *s);
 
   /** reset the whole protocol to start capturing from scratch. */
-  void _resetProtocol(Protocol *p);
+  void _resetProtocol(const Protocol *p, ProtState *s);
+
+  /** initialize the parsing state of a protocol. */
+  void _initState(const Protocol *p, ProtState *s);
 
-  /** use the callback function when registered using format <protocolname> <sequence> */
-  void _useCallback(Protocol *p);
+  /** return the size of the bundle record of a protocol. */
+  static size_t _recordSize(const Protocol *p);
+
+  /** write the bundle record of a protocol, returns the size of the record. */
+  static size_t _writeRecord(const Protocol *p, uint8_t *rec);
+
+  /** read and check a bundle record of at most len bytes into a protocol.
+   * @return the size of the record or 0 when it is not valid.
+   */
+  static size_t _readRecord(const uint8_t *rec, size_t len, Protocol *p);
+
+  /** use the callback function or queue when registered using format <protocolname> <sequence> */
+  void _useCallback(const Protocol *p, ProtState *s);
+
+  /** pass a code to the queue or callback function with the position and number of its durations. */
+  void _emitCode(const char *name, const char *seq, int device, unsigned long start, int length, CodeTime base);
+
+  /** pass the reported fingerprint, the burst is followed by the given number of durations. */
+  void _useFingerprint(int after);
+
+  /** check the last added code using the pattern, subscriptions and validate function. */
+  bool _validateCode(const Protocol *p, ProtState *s);
 
   /** check if the duration fits for the protocol */
-  void _parseProtocol(Protocol *p, CodeTime duration);
+  void _parseProtocol(const Protocol *p, ProtState *s, CodeTime duration);
+
+  /** calculate the window of a time factor for the base times lowBase to highBase. */
+  static void _calcWindow(unsigned long time, CodeTime lowBase, CodeTime highBase, unsigned int tolerance,
+                          CodeTime *minTime, CodeTime *maxTime);
+
+  /** calculate the windows of the codes for the base time of the protocol or the range up to otherBase. */
+  void _calcProtocol(Protocol *protocol);
 
-  /** recalculate adjusted timings. */
-  void _recalcProtocol(Protocol *protocol, CodeTime baseTime);
+  /** calculate all members of a protocol that are calculated by load(). */
+  void _prepareProtocol(Protocol *protocol, CodeTime otherBaseTime);
+
+  /** recalculate the windows of the codes in the parsing state for a tracked base time. */
+  void _recalcState(const Protocol *p, ProtState *s, CodeTime baseTime);
+
+  /** adjust the base time by the timings of a completely received code. */
+  void _trackBase(const Protocol *p, ProtState *s, const Code *c, CodeState *cs);
+
+  /** adjust the trim by the deviations of the marks and spaces of an accepted sequence. */
+  void _learnTrim(const Protocol *p, ProtState *s);
+
+  /** calculate the start prefilter from the first timing of all start codes including the trim. */
+  void _calcStartFilter(const Protocol *p, ProtState *s);
 
 
   // ===== public functions =====
 
 public:
+  /** free the protocol table, subscriptions and the queue allocated by the parser. */
+  ~SignalParser();
+
   /** attach a callback function that will get passed any new code. */
   void attachCallback(CallbackFunction newFunction);
 
+  /** attach a queue that will get any new code instead of the callback function.
+   * The callback function is then used by dispatch().
+   * @param queue the queue or nullptr to use the callback function directly.
+   */
+  void attachQueue(SignalQueue *queue);
+
+  /** use a queue owned by the parser for any new code instead of the callback function.
+   * The codes are collected without any allocation while parsing and passed to the
+   * callback function by dispatch() e.g. after a batch of timings.
+   * The SignalCollector also dispatches while parsing a batch when the queue is half full.
+   */
+  void enableQueue();
+
+  /** fingerprint the signals that are not decoded by any loaded protocol.
+   * Repeated unknown bursts are passed to the callback function or queue as "fp <hash> <length> <base>".
+   * @param fingerprint the fingerprint stage or nullptr to stop fingerprinting.
+   */
+  void attachFingerprint(SignalFingerprint *fingerprint) {
+    _fingerprint = fingerprint;
+  };
+
+  /** return the device id of the subscription that matches the code sequence
+   * passed to the callback function or -1 when the protocol has no subscriptions.
+   */
+  int getDevice() {
+    return (_device);
+  };
+
+  /** return the number of parsed durations that is used as the position of the next duration. */
+  unsigned long getPosition() {
+    return (_position);
+  };
+
+  /** return the position of the oldest duration that may be part of a sequence not finished yet. */
+  unsigned long getOldestPosition();
+
+  /** return the position of the first duration of the code sequence passed to the callback function. */
+  unsigned long getFrameStart() {
+    return (_frameStart);
+  };
+
+  /** return the number of durations of the code sequence passed to the callback function
+   * or 0 when called outside the callback function or by dispatch().
+   */
+  int getFrameLength() {
+    return (_frameLength);
+  };
+
+  /** return the base time recovered from the code sequence passed to the callback function
+   * e.g. to find the sender of a protocol loaded with a range of base times.
+   * This is not available in the callback function called by dispatch().
+   */
+  CodeTime getBaseTime() {
+    return (_frameBase);
+  };
+
+  /** return the queue in use or nullptr. */
+  SignalQueue *getQueue() {
+    return (_queue);
+  };
+
+  /** pass all queued codes to the callback function.
+   * @return number of dispatched codes.
+   */
+  int dispatch();
+
   // return the number of send repeats that should occure.
   int getSendRepeat(char *name);
 
+  // return the carrier frequency used for sending or 0 for no carrier.
+  unsigned int getCarrier(char *name, unsigned int *dutyCycle = nullptr);
+
   /** parse a single duration.
    * @param duration check if this duration fits to any definitions.
    */
   void parse(CodeTime duration);
 
+  /** parse a block of durations, e.g. when replaying a capture.
+   * The durations are classified against the start codes of all protocols at once so
+   * idle protocols are only checked when a start code can begin with the duration.
+   * @param durations the durations to parse.
+   * @param count the number of durations.
+   */
+  void parse(const CodeTime *durations, int count);
+
+  /** finish all started sequences when no more timings will follow e.g. after a timeout.
+   * Sequences with at least minCodeLen codes are passed to the callback, all other are dropped.
+   * @return number of finished sequences.
+   */
+  int flush();
+
+  /** convert a measured duration into a CodeTime by saturating long gaps. */
+  static CodeTime toCodeTime(unsigned long duration) {
+    return (duration < SP_MAXTIME ? duration : SP_MAXTIME);
+  }
+
   /** compose the timings of a sequence by using the code table.
    * @param sequence textual representation using "<protocolname> <codes>".
+   * @param timings target timing buffer, terminated by a 0 timing.
+   * @param len length of the timing buffer.
    */
   void compose(const char *sequence, CodeTime *timings, int len);
 
-  /** Load a protocol to be used. */
+  /** Lock the protocols, subscriptions and trim while another task or thread is parsing,
+   * e.g. while the pipelined mode of the SignalCollector is started.
+   * While locked load(), setTrim(), subscribe(), clearSubscriptions() and useBundle()
+   * change nothing and report an error as they reallocate or reset memory used by the parser.
+   * @param lock true to lock, false to allow changes again.
+   */
+  void lockChanges(bool lock) {
+    _locked = lock;
+  };
+
+  /** Load a protocol to be used.
+   * Not possible while changes are locked, see lockChanges().
+   * @param protocol The protocol definition.
+   * @param otherBaseTime The other end of a range of base times starting at protocol->baseTime
+   * to receive senders with different clocks. The start code is accepted for all base times
+   * in the range and the following codes are checked using the base time of the start code.
+   */
   void load(Protocol *protocol, CodeTime otherBaseTime = 0);
 
+  /** Set the trim of all protocols, e.g. for a receiver that is known to stretch the marks.
+   * Received marks are shortened and spaces are extended by the trim before parsing,
+   * composed marks are shortened and spaces are extended for sending.
+   * Not possible while changes are locked, see lockChanges().
+   * @param trim The time in µsecs marks are received longer than spaces, may be negative.
+   */
+  void setTrim(int trim);
+
+  /** Learn the trim of every protocol from the accepted sequences by comparing the received
+   * marks and spaces with the timings of the codes. Tighter tolerances can then be used.
+   */
+  void learnTrim(bool enable = true) {
+    _trimLearn = enable;
+  };
+
+  /** Return the trim of a protocol in µsecs. */
+  int getTrim(const char *name);
+
+  /** Return the windows of the timings of the first start code of a protocol
+   * as used when the protocol is idle, e.g. to define a capture trigger.
+   * @param name The name of the protocol.
+   * @param minTime target for the minimal timings.
+   * @param maxTime target for the maximal timings.
+   * @param len length of the targets.
+   * @return number of timings or 0 when the protocol or a start code was not found.
+   */
+  int getStartWindows(const char *name, CodeTime *minTime, CodeTime *maxTime, int len);
+
+  /** Subscribe to code sequences of a protocol starting with a prefix.
+   * When a protocol has subscriptions only matching sequences are passed to the callback
+   * and other sequences are dropped as soon as they cannot match any more.
+   * Subscriptions should be added before parsing and after useBundle()
+   * and are not possible while changes are locked, see lockChanges().
+   * @param name The name of the protocol.
+   * @param prefix The codes at the start of the sequence, e.g. "s##__##__".
+   * @param device The device id passed by getDevice(), 0...32767.
+   * @return true when the subscription was added.
+   */
+  bool subscribe(const char *name, const char *prefix, int device = 0);
+
+  /** Remove all subscriptions so all sequences are passed to the callback again.
+   * Not possible while changes are locked, see lockChanges().
+   * @return true when the subscriptions were removed.
+   */
+  bool clearSubscriptions();
+
+  /** Return the size of a bundle containing the loaded protocols. */
+  size_t getBundleSize();
+
+  /** Write the loaded protocols into a bundle.
+   * The bundle can be stored in a file or flash partition and used by useBundle() on any platform.
+   * Protocols with a validate function cannot be saved as the function is only valid in this program.
+   * @return size of the bundle or 0 when the buffer is too small or a protocol has a validate function.
+   */
+  size_t saveBundle(void *buffer, size_t len);
+
+  /** Use the protocols of a bundle instead of the loaded protocols.
+   * The bundle is only read so it can be in flash, a read-only file mapping or any other read-only memory.
+   * Every record is checked and read into a protocol record in RAM with its windows and parsing state.
+   * The memory is allocated when the bundle has more protocols than the bundles used before.
+   * Not possible while changes are locked, see lockChanges().
+   * @param bundle The bundle or nullptr to use the loaded protocols again.
+   * @param len The size of the bundle memory.
+   * @return true when the bundle and all its protocol records are valid and in use.
+   */
+  bool useBundle(const void *bundle, size_t len);
+
   // ===== debug helpers =====
 
   /** Send a summary of the current code-table to the output. */
-  void dumpProtocol(Protocol *p) {
+  void dumpProtocol(const Protocol *p, const ProtState *s) {
     TRACE_MSG("dump %08x", p);
 
-    if (p) {
+    if (p && s) {
       // dump the Protocol characteristics
-      RAW_MSG("Protocol '%s', min:%d max:%d tol:%02u rep:%d\n",
+      RAW_MSG("Protocol '%s', min:%d max:%d tol:%02u rep:%d trim:%d starts:%lu frames:%lu rejects:%lu\n",
               p->name, p->minCodeLen, p->maxCodeLen, p->tolerance,
-              p->sendRepeat);
+              p->sendRepeat, s->trim, s->startCount, s->frameCount, s->rejectCount);
 
-      Code *c = p->codes;
+      const Code *c = p->codes;
       int cnt = p->codeLength;
 
       while (c && cnt) {
@@ -213,9 +680,8 @@ public:
 
   /** Send a summary of the current code-table to the output. */
   void dumpTable() {
-    for (int n = 0; n < _protocolCount; n++) {
-      Protocol *p = _protocol[n];
-      dumpProtocol(p);
+    for (int n = 0; n < _getProtCount(); n++) {
+      dumpProtocol(_getProt(n), _getState(n));
     }  // for
   }    // dumpTable()
 };     // class
@@ -0,0 +1,87 @@
+/**
+ * @file SignalQueue.cpp
+ *
+ * This file is part of the RFCodes library that implements receiving an sending
+ * RF and IR protocols.
+ *
+ * @copyright Copyright (c) by Matthias Hertel, https://www.mathertel.de.
+ *
+ * This work is licensed under a BSD 3-Clause style license,
+ * https://www.mathertel.de/License.aspx.
+ *
+ * @brief
+ * A queue of decoded code sequences with a fixed capacity.
+ *
+ * Change History see SignalQueue.h
+ */
+
+#include <Arduino.h>
+
+#include "SignalQueue.h"
+
+
+/** Add a decoded sequence using the format <protocolname> <sequence>. */
+bool SignalQueue::push(const char *name, const char *seq, int device) {
+  unsigned int head = _head.load(std::memory_order_relaxed);
+  unsigned int cnt = head - _tail.load(std::memory_order_acquire);
+
+  if (cnt >= SQ_CAPACITY) {
+    _dropped = _dropped + 1;
+    return (false);
+  }
+
+  // copy "<protocolname> <sequence>" into the free slot.
+  char *tar = _frames[head & (SQ_CAPACITY - 1)];
+  char *end = tar + SQ_FRAMELEN - 1;
+  while (*name && (tar < end)) {
+    *tar++ = *name++;
+  }
+  if (tar < end) {
+    *tar++ = ' ';
+  }
+  while (*seq && (tar < end)) {
+    *tar++ = *seq++;
+  }
+  *tar = NUL;
+  _devices[head & (SQ_CAPACITY - 1)] = device;
+
+  _head.store(head + 1, std::memory_order_release);
+  if (cnt + 1 > _maxCount) {
+    _maxCount = cnt + 1;
+  }
+  return (true);
+}  // push()
+
+
+/** Return the oldest frame text in the queue or nullptr when empty. */
+const char *SignalQueue::peek() {
+  unsigned int tail = _tail.load(std::memory_order_relaxed);
+
+  if (tail == _head.load(std::memory_order_acquire)) {
+    return (nullptr);
+  }
+  return (_frames[tail & (SQ_CAPACITY - 1)]);
+}  // peek()
+
+
+/** Return the device id of the oldest frame in the queue. */
+int SignalQueue::getDevice() {
+  unsigned int tail = _tail.load(std::memory_order_relaxed);
+
+  if (tail == _head.load(std::memory_order_acquire)) {
+    return (-1);
+  }
+  return (_devices[tail & (SQ_CAPACITY - 1)]);
+}  // getDevice()
+
+
+/** Remove the oldest frame from the queue. */
+void SignalQueue::pop() {
+  unsigned int tail = _tail.load(std::memory_order_relaxed);
+
+  if (tail != _head.load(std::memory_order_acquire)) {
+    _tail.store(tail + 1, std::memory_order_release);
+  }
+}  // pop()
+
+// End.
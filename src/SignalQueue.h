@@ -0,0 +1,81 @@
+/**
+ * @file: SignalQueue.h
+ *
+ * This file is part of the RFCodes library that implements receiving an sending
+ * RF and IR protocols.
+ *
+ * @copyright Copyright (c) by Matthias Hertel, https://www.mathertel.de.
+ *
+ * This work is licensed under a BSD 3-Clause style license,
+ * https://www.mathertel.de/License.aspx.
+ *
+ * @brief
+ * A queue of decoded code sequences with a fixed capacity.
+ * The queue is lock-free for exactly one producer (the parser) and one
+ * consumer (the dispatcher) and can be used between threads or cores.
+ *
+ * Changelog:
+ * * 18.10.2026 created by agent
+ * * 18.10.2026 device id of subscriptions per frame.
+ */
+
+#ifndef SignalQueue_H_
+#define SignalQueue_H_
+
+#include <atomic>
+
+#include "SignalParser.h"
+
+#define SQ_CAPACITY 8                                         // number of frames in the queue, must be a power of 2
+#define SQ_FRAMELEN (PROTNAME_LEN + MAX_SEQUENCE_LENGTH + 1)  // maximal length of a frame text "<protocolname> <sequence>"
+
+class SignalQueue {
+public:
+  /** Add a decoded sequence using the format <protocolname> <sequence>.
+   * @param device The device id of a subscription or -1.
+   * @return false when the queue is full and the frame was dropped.
+   */
+  bool push(const char *name, const char *seq, int device = -1);
+
+  /** Return the oldest frame text in the queue or nullptr when empty.
+   * The frame stays valid until pop() is called.
+   */
+  const char *peek();
+
+  /** Return the device id of the oldest frame in the queue. */
+  int getDevice();
+
+  /** Remove the oldest frame from the queue. */
+  void pop();
+
+  // ===== Insights and Debugging Helpers =====
+
+  // Return the number of frames in the queue.
+  unsigned int getCount() {
+    return ((unsigned int)(_head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire)));
+  };
+
+  // Return the maximum number of frames in the queue that have been seen.
+  unsigned int getMaxCount() {
+    return (_maxCount);
+  };
+
+  // Return the number of frames that have been dropped because the queue was full.
+  unsigned long getDropped() {
+    return (_dropped);
+  };
+
+private:
+  char _frames[SQ_CAPACITY][SQ_FRAMELEN];
+  int _devices[SQ_CAPACITY];
+
+  // free running indexes, only written by the producer (_head) or the consumer (_tail).
+  std::atomic<unsigned int> _head{0};
+  std::atomic<unsigned int> _tail{0};
+
+  // statistics, only written by the producer.
+  volatile unsigned int _maxCount = 0;
+  volatile unsigned long _dropped = 0;
+};  // class SignalQueue
+
+#endif  // SignalQueue_H_
@@ -0,0 +1,119 @@
+/**
+ * @file SignalReceiver.cpp
+ *
+ * This file is part of the RFCodes library that implements receiving an sending
+ * RF and IR protocols.
+ *
+ * @copyright Copyright (c) by Matthias Hertel, https://www.mathertel.de.
+ *
+ * This work is licensed under a BSD 3-Clause style license,
+ * https://www.mathertel.de/License.aspx.
+ *
+ * @brief
+ * Receive backends delivering blocks of timings to the SignalCollector.
+ *
+ * Change History see SignalReceiver.h
+ */
+
+#include <Arduino.h>
+
+#include "SignalReceiver.h"
+#include "SignalCollector.h"
+
+
+// ===== SignalReceiverRMT =====
+
+#if defined(ESP32)
+
+// The RMT API of the Arduino core 3.x is used. Core 2.x is not supported.
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && (ESP_ARDUINO_VERSION_MAJOR >= 3)
+#define SR_RMT_SUPPORTED
+#endif
+
+
+/** Start receiving. */
+bool SignalReceiverRMT::begin()
+{
+#if defined(SR_RMT_SUPPORTED)
+  // 1 MHz resolution: a tick is 1 µsec. 2 memory blocks hold SR_RMT_SYMBOLS symbols.
+  if (rmtInit(_pin, RMT_RX_MODE, RMT_MEM_NUM_BLOCKS_2, 1000000)) {
+    rmtSetRxMaxThreshold(_pin, _idle);
+    if (_filter) {
+      rmtSetRxMinThreshold(_pin, _filter);
+    }
+    _symbolCount = SR_RMT_SYMBOLS;
+    _active = rmtReadAsync(_pin, (rmt_data_t *)_symbols, &_symbolCount);
+  }
+#endif
+  return (_active);
+} // begin()
+
+
+/** Stop receiving. */
+void SignalReceiverRMT::end()
+{
+#if defined(SR_RMT_SUPPORTED)
+  if (_active) {
+    rmtDeinit(_pin);
+    _active = false;
+  }
+#endif
+} // end()
+
+
+/** Pass a completely received block to the collector. */
+void SignalReceiverRMT::poll(SignalCollector *col)
+{
+#if defined(SR_RMT_SUPPORTED)
+  if (_active && rmtReceiveCompleted(_pin)) {
+    rmt_data_t *s = (rmt_data_t *)_symbols;
+    int n = 0;
+
+    for (size_t i = 0; i < _symbolCount; i++) {
+      // a 0 duration marks the end of the block.
+      if (s[i].duration0)
+        _timings[n++] = s[i].duration0;
+      if (s[i].duration1)
+        _timings[n++] = s[i].duration1;
+    } // for
+
+    // the block was finished by a gap longer than the idle time.
+    _timings[n++] = _idle;
+    col->receiveTimings(_timings, n);
+
+    // receive the next block
+    _symbolCount = SR_RMT_SYMBOLS;
+    rmtReadAsync(_pin, s, &_symbolCount);
+  } // if
+#else
+  (void)col;
+#endif
+} // poll()
+
+#endif
+
+
+// ===== SignalReceiverReplay =====
+
+
+/** Start passing the timings from the beginning. */
+bool SignalReceiverReplay::begin()
+{
+  _pos = 0;
+  return (true);
+} // begin()
+
+
+/** Pass the next block of timings to the collector. */
+void SignalReceiverReplay::poll(SignalCollector *col)
+{
+  if (_pos < _count) {
+    unsigned long n = _count - _pos;
+    if (n > (unsigned long)_blockSize)
+      n = _blockSize;
+    col->receiveTimings(_timings + _pos, n);
+    _pos += n;
+  }
+} // poll()
+
+// End.
@@ -0,0 +1,110 @@
+/**
+ * @file: SignalReceiver.h
+ *
+ * This file is part of the RFCodes library that implements receiving an sending
+ * RF and IR protocols.
+ *
+ * @copyright Copyright (c) by Matthias Hertel, https://www.mathertel.de.
+ *
+ * This work is licensed under a BSD 3-Clause style license,
+ * https://www.mathertel.de/License.aspx.
+ *
+ * @brief
+ * Receive backends delivering blocks of timings to the SignalCollector
+ * instead of using an interrupt for every signal change.
+ *
+ * * SignalReceiverRMT captures the timings using the RMT peripheral of the ESP32.
+ * * SignalReceiverReplay passes recorded timings e.g. for tests and benchmarks on a host.
+ *
+ * Changelog:
+ * * 18.10.2026 created by agent
+ */
+
+#ifndef SignalReceiver_H_
+#define SignalReceiver_H_
+
+#include "SignalParser.h"
+
+class SignalCollector;
+
+// Base class of the receive backends.
+class SignalReceiver {
+public:
+  virtual ~SignalReceiver() {}
+
+  /** Start receiving.
+   * @return true when receiving is supported and started.
+   */
+  virtual bool begin() = 0;
+
+  /** Stop receiving. */
+  virtual void end() {}
+
+  /** Pass the timings received since the last call to the collector using receiveTimings().
+   * This is called by loop() or the task of the pipelined mode.
+   */
+  virtual void poll(SignalCollector *col) = 0;
+};  // class SignalReceiver
+
+
+#if defined(ESP32)
+
+#define SR_RMT_SYMBOLS 128  // number of RMT symbols (2 timings each) in a block
+
+// Capture the timings using the RMT peripheral of the ESP32 with a resolution of 1 µsec.
+// A block is finished by a gap longer than the idle time and is passed as a whole.
+class SignalReceiverRMT : public SignalReceiver {
+public:
+  /**
+   * @param pin The IO pin of the receiver.
+   * @param idle The gap in µsecs that finishes a block, up to 32767.
+   * @param filter Pulses shorter than this time in µsecs are ignored, up to 255.
+   */
+  SignalReceiverRMT(int pin, SignalParser::CodeTime idle = 12000, uint8_t filter = 0)
+    : _pin(pin), _idle(idle), _filter(filter){};
+
+  bool begin() override;
+  void end() override;
+  void poll(SignalCollector *col) override;
+
+private:
+  int _pin;
+  SignalParser::CodeTime _idle;
+  uint8_t _filter;
+  bool _active = false;
+
+  uint32_t _symbols[SR_RMT_SYMBOLS];
+  size_t _symbolCount = 0;
+  SignalParser::CodeTime _timings[2 * SR_RMT_SYMBOLS + 1];
+};  // class SignalReceiverRMT
+
+#endif
+
+
+// Pass recorded timings in blocks e.g. for tests and benchmarks on a host.
+class SignalReceiverReplay : public SignalReceiver {
+public:
+  /**
+   * @param timings The recorded timings.
+   * @param count The number of timings.
+   * @param blockSize The number of timings passed by one poll().
+   */
+  SignalReceiverReplay(const SignalParser::CodeTime *timings, unsigned long count, int blockSize = 64)
+    : _timings(timings), _count(count), _blockSize(blockSize){};
+
+  bool begin() override;
+  void poll(SignalCollector *col) override;
+
+  /** Return true when all timings have been passed. */
+  bool done() {
+    return (_pos >= _count);
+  };
+
+private:
+  const SignalParser::CodeTime *_timings;
+  unsigned long _count;
+  int _blockSize;
+  unsigned long _pos = 0;
+};  // class SignalReceiverReplay
+
+#endif  // SignalReceiver_H_
@@ -0,0 +1,237 @@
+/**
+ * @file SignalSimulator.cpp
+ *
+ * This file is part of the RFCodes library that implements receiving an sending
+ * RF and IR protocols.
+ *
+ * @copyright Copyright (c) by Matthias Hertel, https://www.mathertel.de.
+ *
+ * This work is licensed under a BSD 3-Clause style license,
+ * https://www.mathertel.de/License.aspx.
+ *
+ * @brief
+ * This channel simulator creates timings of random code sequences using the
+ * protocol definitions and disturbes them like a real RF or IR channel does.
+ *
+ * Change History see SignalSimulator.h
+ */
+
+#include <Arduino.h>
+
+#include "SignalSimulator.h"
+
+#define SIM_NEVER (~0UL)  // end time of a finished signal
+
+
+// ===== private functions =====
+
+
+/** create a random code sequence of a protocol into the buffer. */
+void SignalSimulator::_randomCode(int n, char *code) {
+  SignalParser::Protocol *p = _protocols[n];
+  char startCodes[MAX_CODELENGTH];
+  char dataCodes[MAX_CODELENGTH];
+  char endCodes[MAX_CODELENGTH];
+  int startCnt = 0, dataCnt = 0, endCnt = 0;
+
+  // sort the codes by their usage
+  for (int cl = 0; cl < p->codeLength; cl++) {
+    SignalParser::Code *c = &(p->codes[cl]);
+    if (c->type & SignalParser::START) {
+      startCodes[startCnt++] = c->name;
+    }
+    if (c->type & SignalParser::END) {
+      endCodes[endCnt++] = c->name;
+    } else if (c->type & SignalParser::DATA) {
+      dataCodes[dataCnt++] = c->name;
+    }
+  }  // for
+
+  // protocols without end code are only complete with the maximal length.
+  int len = p->maxCodeLen;
+  if (endCnt) {
+    len = p->minCodeLen + random(p->maxCodeLen - p->minCodeLen + 1);
+  }
+  if (len > MAX_SEQUENCE_LENGTH - 1) {
+    len = MAX_SEQUENCE_LENGTH - 1;
+  }
+
+  strcpy(code, p->name);
+  char *s = code + strlen(code);
+  *s++ = ' ';
+
+  for (int i = 0; i < len; i++) {
+    if ((i == 0) && startCnt) {
+      *s++ = startCodes[random(startCnt)];
+    } else if ((i == len - 1) && endCnt) {
+      *s++ = endCodes[random(endCnt)];
+    } else if (dataCnt) {
+      *s++ = dataCodes[random(dataCnt)];
+    }
+  }  // for
+  *s = NUL;
+}  // _randomCode()
+
+
+/** compose the sequence and return the number of timings. */
+int SignalSimulator::_compose(const char *sequence, SignalParser::CodeTime *timings) {
+  int cnt = 0;
+
+  _sig->compose(sequence, timings, SIM_BUFFERSIZE);
+  while (timings[cnt]) {
+    cnt++;
+  }
+  return (cnt);
+}  // _compose()
+
+
+/** copy the timings and apply skew, jitter, glitches and dropouts. */
+int SignalSimulator::_disturb(const Channel &channel, SignalParser::CodeTime *src, int cnt, SignalParser::CodeTime *timings, int len) {
+  long skew = (long)random(2 * channel.skew + 1) - channel.skew;
+  int n = 0;
+
+  for (int i = 0; (i < cnt) && (n < len); i++) {
+    long t = src[i];
+
+    if ((channel.dropout) && (i + 2 < cnt) && (random(1000) < channel.dropout)) {
+      // a lost pulse joins this timing with the next 2 timings.
+      t += src[i + 1] + src[i + 2];
+      i += 2;
+    }
+
+    t += (t * skew) / 100;
+    if (channel.jitter) {
+      t += (t * ((long)random(2 * channel.jitter + 1) - (long)channel.jitter)) / 100;
+    }
+
+    if ((channel.glitch) && (random(1000) < channel.glitch) && (n + 3 <= len) && (t > 100)) {
+      // a short glitch splits this timing into 3 timings.
+      long g = 10 + random(60);
+      long a = 1 + random(t - g - 1);
+      timings[n++] = a;
+      timings[n++] = g;
+      t = t - a - g;
+    }
+
+    timings[n++] = SignalParser::toCodeTime(t > 0 ? t : 1);
+  }  // for
+  return (n);
+}  // _disturb()
+
+
+/** combine the signal of two senders, the other one starting after offset. */
+int SignalSimulator::_overlap(SignalParser::CodeTime *a, int na, SignalParser::CodeTime *b, int nb, unsigned long offset,
+                              SignalParser::CodeTime *timings, int len) {
+  // both signals start with a high level, the other one after a low level until offset.
+  int ia = 0, ib = -1;
+  unsigned long endA = (na > 0) ? a[0] : SIM_NEVER;
+  unsigned long endB = (nb > 0) ? offset : SIM_NEVER;
+  bool highA = (na > 0), highB = false;
+
+  bool level = highA;
+  unsigned long now = 0, lastEdge = 0;
+  int n = 0;
+
+  while (((endA != SIM_NEVER) || (endB != SIM_NEVER)) && (n < len)) {
+    now = (endA < endB) ? endA : endB;
+
+    if (endA == now) {
+      ia++;
+      if (ia < na) {
+        endA += a[ia];
+        highA = !highA;
+      } else {
+        endA = SIM_NEVER;
+        highA = false;
+      }
+    }
+
+    if (endB == now) {
+      ib++;
+      if (ib < nb) {
+        endB += b[ib];
+        highB = !highB;
+      } else {
+        endB = SIM_NEVER;
+        highB = false;
+      }
+    }
+
+    if ((highA || highB) != level) {
+      timings[n++] = SignalParser::toCodeTime(now - lastEdge);
+      lastEdge = now;
+      level = !level;
+    }
+  }  // while
+
+  // the final low level lasts until both signals are finished.
+  if ((n < len) && (now > lastEdge)) {
+    timings[n++] = SignalParser::toCodeTime(now - lastEdge);
+  }
+  return (n);
+}  // _overlap()
+
+
+// ===== public functions =====
+
+
+/** Initialize the simulator. */
+void SignalSimulator::init(SignalParser *sig, SignalParser::Protocol **protocols, int count, unsigned long seed) {
+  _sig = sig;
+  _protocols = protocols;
+  _protocolCount = count;
+  _seed = seed ? seed : 1;
+}  // init()
+
+
+/** Return a pseudo random number in the range 0...max-1 using xorshift32. */
+unsigned long SignalSimulator::random(unsigned long max) {
+  uint32_t x = _seed;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  _seed = x;
+  return (max ? (x % max) : 0);
+}  // random()
+
+
+/** Create a random but valid code sequence of a protocol. */
+const char *SignalSimulator::randomCode(int n) {
+  _randomCode(n, _code);
+  return (_code);
+}  // randomCode()
+
+
+/** Create the timings of a code sequence transmitted through the channel. */
+int SignalSimulator::transmit(const char *sequence, const Channel &channel, SignalParser::CodeTime *timings, int len) {
+  int n = 0;
+
+  // noise before the sequence
+  int noiseCnt = random(channel.noise + 1);
+  while ((noiseCnt--) && (n < len)) {
+    timings[n++] = 30 + random(3000);
+  }
+
+  int cnt = _disturb(channel, _work, _compose(sequence, _work), _frame, SIM_BUFFERSIZE);
+
+  if ((channel.overlap) && (_protocolCount) && (random(100) < channel.overlap)) {
+    // another sender is transmitting at the same time.
+    char other[PROTNAME_LEN + MAX_SEQUENCE_LENGTH + 1];
+    _randomCode(random(_protocolCount), other);
+    int otherCnt = _disturb(channel, _work, _compose(other, _work), _other, SIM_BUFFERSIZE);
+
+    unsigned long total = 0;
+    for (int i = 0; i < cnt; i++) {
+      total += _frame[i];
+    }
+    n += _overlap(_frame, cnt, _other, otherCnt, random(total + 1), timings + n, len - n);
+
+  } else {
+    for (int i = 0; (i < cnt) && (n < len); i++) {
+      timings[n++] = _frame[i];
+    }
+  }
+  return (n);
+}  // transmit()
+
+// End.
@@ -0,0 +1,95 @@
+/**
+ * @file: SignalSimulator.h
+ *
+ * This file is part of the RFCodes library that implements receiving an sending
+ * RF and IR protocols.
+ *
+ * @copyright Copyright (c) by Matthias Hertel, https://www.mathertel.de.
+ *
+ * This work is licensed under a BSD 3-Clause style license,
+ * https://www.mathertel.de/License.aspx.
+ *
+ * @brief
+ * This channel simulator creates timings of random code sequences using the
+ * protocol definitions and disturbes them like a real RF or IR channel does.
+ * It can be used to measure the decode rate and the performance of the
+ * SignalParser with repeatable results.
+ *
+ * Changelog:
+ * * 18.10.2026 created by agent
+ */
+
+#ifndef SignalSimulator_H_
+#define SignalSimulator_H_
+
+#include "SignalParser.h"
+
+#define SIM_BUFFERSIZE 384  // maximal number of timings of a simulated transmission
+
+class SignalSimulator {
+public:
+  // The characteristics of the simulated channel.
+  struct Channel {
+    unsigned int jitter;   // random deviation of every timing in percent.
+    unsigned int skew;     // random deviation of the sender clock in percent.
+    unsigned int glitch;   // probability of a short glitch inside a timing in permille.
+    unsigned int dropout;  // probability of a lost pulse in permille.
+    unsigned int noise;    // maximal number of random noise timings before a sequence.
+    unsigned int overlap;  // probability of another sender overlapping the sequence in percent.
+  };
+
+  /**
+   * @brief Initialize the simulator.
+   * @param sig The parser with the loaded protocols used to compose the timings.
+   * @param protocols The protocols used for random code sequences.
+   * @param count The number of protocols.
+   * @param seed The start value of the random numbers to get repeatable results.
+   */
+  void init(SignalParser *sig, SignalParser::Protocol **protocols, int count, unsigned long seed = 1);
+
+  /** Create a random but valid code sequence of a protocol.
+   * @param n index of the protocol as passed in init().
+   * @return textual representation using "<protocolname> <codes>".
+   */
+  const char *randomCode(int n);
+
+  /** Create the timings of a code sequence transmitted through the channel.
+   * @param sequence textual representation using "<protocolname> <codes>".
+   * @param channel The characteristics of the channel.
+   * @param timings target timing buffer.
+   * @param len length of buffer.
+   * @return number of timings.
+   */
+  int transmit(const char *sequence, const Channel &channel, SignalParser::CodeTime *timings, int len);
+
+  /** Return a pseudo random number in the range 0...max-1. */
+  unsigned long random(unsigned long max);
+
+private:
+  SignalParser *_sig;
+  SignalParser::Protocol **_protocols;
+  int _protocolCount;
+
+  uint32_t _seed;
+
+  char _code[PROTNAME_LEN + MAX_SEQUENCE_LENGTH + 1];
+
+  SignalParser::CodeTime _work[SIM_BUFFERSIZE];
+  SignalParser::CodeTime _frame[SIM_BUFFERSIZE];
+  SignalParser::CodeTime _other[SIM_BUFFERSIZE];
+
+  /** create a random code sequence of a protocol into the buffer. */
+  void _randomCode(int n, char *code);
+
+  /** compose the sequence and return the number of timings. */
+  int _compose(const char *sequence, SignalParser::CodeTime *timings);
+
+  /** copy the timings and apply skew, jitter, glitches and dropouts. */
+  int _disturb(const Channel &channel, SignalParser::CodeTime *src, int cnt, SignalParser::CodeTime *timings, int len);
+
+  /** combine the signal of two senders, the other one starting after offset. */
+  int _overlap(SignalParser::CodeTime *a, int na, SignalParser::CodeTime *b, int nb, unsigned long offset,
+               SignalParser::CodeTime *timings, int len);
+};  // class SignalSimulator
+
+#endif  // SignalSimulator_H_
@@ -57,7 +57,11 @@ SignalParser::Protocol nec = {
         {SignalParser::CodeType::DATA, '1', {1, 3}},
 
         // Repeat signal is /‾‾(9000)‾‾\__(2250)__/
-        {SignalParser::CodeType::DATA, 'R', {16, 4}}}};
+        {SignalParser::CodeType::DATA, 'R', {16, 4}}},
+
+    // the IR LED is modulated with 38 kHz, 1/3 duty cycle
+    .carrier = 38000,
+    .dutyCycle = 33};
 
 } // namespace IRCodes
 
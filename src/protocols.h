@@ -79,8 +79,57 @@ SignalParser::Protocol ev1527 = {
       }};
 
 
+/** Incremental validation of the cresta protocol, see /docs/cresta_protocol.md
+ * The manchester coded bits are decoded while receiving using the check state:
+ * bits 0-7: current byte, bits 8-11: number of bits, bit 12: last bit, bits 16-23: number of bytes.
+ * The first byte must be 0x9f and the bit between the bytes must be 0. */
+bool cw_validate(const char *seq, int seqLen, unsigned long *check, bool complete)
+{
+  if (complete)
+    return (true); // all checks are done while receiving.
+
+  unsigned long s = *check;
+
+  if (seqLen == 1) {
+    // start code: simulate shifting in bits from header : 10101
+    s = 0x15 | (5 << 8) | (1 << 12);
+
+  } else {
+    unsigned int byte = s & 0xFF;
+    unsigned int bits = (s >> 8) & 0x0F;
+    unsigned int bit = (s >> 12) & 0x01;
+    unsigned int cnt = (s >> 16) & 0xFF;
+
+    if (seq[seqLen - 1] == 'l') {
+      bit = 1 - bit;
+    }
+
+    if (bits < 8) {
+      // shift bit into data byte
+      byte |= bit << bits;
+      bits++;
+
+    } else if (bit) {
+      // the bit inbetween data bytes must be 0
+      return (false);
+
+    } else {
+      byte = (byte ^ (byte << 1)) & 0xFF; // decode
+      if ((cnt == 0) && (byte != 0x9f))
+        return (false);
+      cnt++;
+      bits = 0;
+      byte = 0;
+    }
+    s = byte | (bits << 8) | (bit << 12) | ((unsigned long)cnt << 16);
+  }
+  *check = s;
+  return (true);
+} // cw_validate()
+
+
 /** register the cresta protocol with a length of 59 codes; used for sensor data transmissions.
- * See /docs/cresta_protocol.h */
+ * See /docs/cresta_protocol.md */
 SignalParser::Protocol cw = {
     "cw",
     .minCodeLen = 59,
@@ -92,7 +141,8 @@ SignalParser::Protocol cw = {
     .codes = {
         {SignalParser::CodeType::START, 'H', {2, 2, 2, 2, 2}},
         {SignalParser::CodeType::DATA, 's', {1, 1}},
-        {SignalParser::CodeType::DATA, 'l', {2}}}};
+        {SignalParser::CodeType::DATA, 'l', {2}}},
+    .validate = cw_validate};
 
 } // namespace RFCodes
 